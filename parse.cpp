@@ -7,15 +7,50 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <deque>
 #include <stack>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <queue>
 #include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <filesystem>
+#include <charconv>
+#include <random>
+#include <chrono>
 #include <stdlib.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#ifdef _WIN32
+#else
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 
-enum ERROR_TYPE {NOTSSA, NONE, NAME_ERROR, SYNTEXT_ERROR};
+enum ERROR_TYPE {NOTSSA, NONE, NAME_ERROR, SYNTEXT_ERROR, ANALYSIS_ERROR, BUDGET_WARNING};
 
 class myError
 {
@@ -35,12 +70,20 @@ public:
 			break;
 		case SYNTEXT_ERROR: cout << "at line " << line << " "; cout << "[ERROR] syntax error!\n" << extra << endl;
 			break;
+		case ANALYSIS_ERROR: cout << "at line " << line << " "; cout << "[ERROR] can not analyze!\n" << extra << endl;
+			break;
+		case BUDGET_WARNING: cout << "at line " << line << " "; cout << "[WARNING] out of budget, ranges are approximate!\n" << extra << endl;
+			break;
 		case NONE: cout << "[NONE] no error currently!\n" << extra << endl;
 			break;
 		default:
 			break;
 		}
 	}
+	ERROR_TYPE kind() const { return code; }
+	bool warning() const { return code == BUDGET_WARNING; }	// reported, but the run still succeeds
+	const string& what() const { return extra; }
+	int at() const { return line; }
 	void set(ERROR_TYPE _code, string _extra, int _line)
 	{
 		code = _code;
@@ -49,924 +92,7906 @@ public:
 	}
 };
 
-myError global_error;
-
-enum DATA_TYPE {INT, FLOAT};
-string data_type[] = { "int", "float" };
+/*
+ * tracing. TRACE_LEVEL is the most detailed level compiled in; with the
+ * default 0 every TRACE point folds to nothing and its arguments are never
+ * evaluated. otherwise the runtime level comes from SSA_TRACE and a point
+ * costs one compare while it is off. events go to SSA_TRACE_FILE (default
+ * trace.txt) as they happen, or with SSA_TRACE_RING=n only the last n are
+ * kept in memory and written out at exit.
+ */
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 0
+#endif
 
-enum OP_TYPE {ADD, SUB, MUL, DIV, FLOAT_CAST, INT_CAST, CALL, GOTO_EQ, 
-	GOTO_NE, GOTO_LE, GOTO_GE, GOTO_L, GOTO_G, GOTO, ASSIGN, RETURN};
+enum TRACE_LEVELS {TR_OFF, TR_FUNC, TR_BLOCK, TR_STAT, TR_ITER};
+enum TRACE_EVENT {EV_FUNCTION, EV_BLOCK, EV_STATEMENT, EV_ITERATION, EV_SOLVED};
 
-class Statement
+class TraceEvent
 {
 public:
-	OP_TYPE op;
-	string result = "0";
+	TRACE_EVENT ev;
+	int line;
+	long long a, b;
+	char name[32];	// cut to fit, events must not point into the input
 };
 
-class Exp_stat : public Statement
+class Tracer
 {
+	mutex lock;		// functions are solved in parallel
+	fstream out;
+	vector<TraceEvent> ring;
+	size_t total;		// events recorded so far, ring holds the last ones
+	void write(const TraceEvent &e);
 public:
-	string arg1;
-	string arg2;
+	int level;
+	Tracer();
+	~Tracer();
+	void event(TRACE_EVENT ev, int line, string_view name, long long a = 0, long long b = 0);
+	void flush();
 };
 
-class Call_stat : public Statement
+Tracer::Tracer() : total(0), level(TR_OFF)
 {
-public:
-	string func_name;
-	vector<string> args;
-};
+	if (TRACE_LEVEL == TR_OFF)
+		return;
+	const char *env = getenv("SSA_TRACE");
+	if (env == nullptr)
+		return;
+	level = min(atoi(env), TRACE_LEVEL);
+	if (level <= TR_OFF)
+		return;
+	const char *path = getenv("SSA_TRACE_FILE");
+	out.open(path != nullptr ? path : "trace.txt", ios::out);
+	const char *keep = getenv("SSA_TRACE_RING");
+	if (keep != nullptr && atoi(keep) > 0)
+		ring.resize(atoi(keep));
+}
 
-class VarTable
+Tracer::~Tracer()
 {
-public:
-	string name;
-	DATA_TYPE type;
-	double low, up;
-	char bound[2];
-	VarTable(string _name, DATA_TYPE _type, double _low= -INFINITY, double _up = INFINITY, char low_bound = '[', char up_bound = ']')
+	flush();
+}
+
+void Tracer::event(TRACE_EVENT ev, int line, string_view name, long long a, long long b)
+{
+	lock_guard<mutex> hold(lock);
+	TraceEvent e;
+	e.ev = ev;
+	e.line = line;
+	e.a = a;
+	e.b = b;
+	size_t n = min(name.size(), sizeof(e.name) - 1);
+	memcpy(e.name, name.data(), n);
+	e.name[n] = '\0';
+	if (ring.empty())
+		write(e);
+	else
+		ring[total % ring.size()] = e;
+	total++;
+}
+
+void Tracer::write(const TraceEvent &e)
+{
+	switch (e.ev)
 	{
-		name = _name;
-		type = _type;
-		low = _low;
-		up = _up;
-		bound[0] = low_bound;
-		bound[1] = up_bound;
+	case EV_FUNCTION: out << "function " << e.name << " at line " << e.line << "\n";
+		break;
+	case EV_BLOCK: out << "  block <" << e.name << "> at line " << e.line << "\n";
+		break;
+	case EV_STATEMENT: out << "    " << e.name << " at line " << e.line << ", statement " << e.b << "\n";
+		break;
+	case EV_ITERATION: out << "iterate " << e.name << " block " << e.a << (e.b ? " narrowing" : "") << "\n";
+		break;
+	case EV_SOLVED: out << "solved " << e.name << " in " << e.a << " iterations over " << e.b << " blocks\n";
+		break;
+	default:
+		break;
 	}
-};
+}
 
-class BlockTable
+void Tracer::flush()
 {
-public:
-	string block_name;
-	map<string, VarTable*> IN;
-	map<string, VarTable*> OUT;
-	vector<Statement*> statements;
-	vector<string> next;
-	vector<string> pre;
-	BlockTable(string _name)
+	if (!out.is_open())
+		return;
+	if (!ring.empty())
 	{
-		block_name = _name;
+		size_t n = min(total, ring.size());
+		if (total > n)
+			out << "... " << total - n << " earlier events dropped\n";
+		for (size_t i = total - n; i < total; ++i)
+			write(ring[i % ring.size()]);
+		total = 0;
 	}
-	void draw(fstream &drawer, int indent = 4);
-};
+	out.flush();
+}
 
-void BlockTable::draw(fstream &drawer, int indent)
+Tracer tracer;
+
+#define TRACE(lv, ...) do { if ((lv) <= TRACE_LEVEL && (lv) <= tracer.level) tracer.event(__VA_ARGS__); } while (0)
+
+/*
+ * statistics, kept per input with --stats and written out as json. a phase
+ * is timed by a Stopwatch over its scope; without statistics its counter
+ * is a null pointer and the stopwatch never reads the clock.
+ */
+enum PHASE {PH_LEX, PH_PARSE, PH_WIRE, PH_LOAD, PH_SOLVE, PH_DRAW, PH_COUNT};
+const char *phase_name[] = { "lex", "parse", "wire", "load", "solve", "draw" };
+
+class Stopwatch
 {
-	string white;
-	for (int i = 0; i < indent; ++i)
-		white.append(" ");
-	drawer << white << "<" << block_name << ">" << endl;
-	drawer << white << "PRE:(";
-	for (auto i = pre.begin(); i != pre.end(); ++i)
-		drawer << *i << ",";
-	drawer << ")" << endl;
-	drawer << white << "IN:( ";
-	for (auto i = IN.begin(); i != IN.end(); ++i)
+	long long *acc;		// nanoseconds, nullptr when not timing
+	chrono::steady_clock::time_point start;
+public:
+	Stopwatch(long long *_acc) : acc(_acc)
 	{
-		drawer << i->second->name << "(" << data_type[i->second->type] << ")" << ":" << i->second->bound[0] << i->second->low << "," << i->second->up << i->second->bound[1] << "  ";
+		if (acc != nullptr)
+			start = chrono::steady_clock::now();
 	}
-	drawer << ")" << endl;
-	drawer << white << "statements:" << endl;
-	int counter = 1;
-	for (auto i = 0; i < statements.size(); ++i)
+	~Stopwatch()
 	{
-		if (statements[i]->op == ADD)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "ADD " << p->result << "," << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == SUB)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "SUB " << p->result << "," << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == MUL)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "MUL " << p->result << "," << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == DIV)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "DIV " << p->result << "," << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == CALL)
-		{
-			auto p = (Call_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "CALL " << p->result << "," << p->func_name << "(";
-			for (auto j = p->args.begin(); j != p->args.end(); ++j)
-				drawer << *j << ",";
-			drawer << ")" << endl;
-		}
-		else if (statements[i]->op == ASSIGN)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "ASSIGN " << p->result << "," << p->arg1 << endl;
-		}
-		else if (statements[i]->op == INT_CAST)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "CAST_TO_INT " << p->result << "," << p->arg1 << endl;
-		}
-		else if (statements[i]->op == FLOAT_CAST)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "CAST_TO_FLOAT " << p->result << "," << p->arg1 << endl;
-		}
-		else if (statements[i]->op == GOTO)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO " << p->result << endl;
-		}
-		else if (statements[i]->op == GOTO_EQ)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_EQ " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == GOTO_NE)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_NE " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == GOTO_G)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_G " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == GOTO_GE)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_GE " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == GOTO_L)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_L " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == GOTO_LE)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "GOTO_LE " << p->arg1 << "," << p->arg2 << endl;
-		}
-		else if (statements[i]->op == RETURN)
-		{
-			auto p = (Exp_stat*)statements[i];
-			drawer << white << "    " << "(" << counter++ << ")" << "RETURN " << p->result << endl;
-		}
+		if (acc != nullptr)
+			*acc += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
 	}
-	drawer << white << "OUT:( ";
-	for (auto i = OUT.begin(); i != OUT.end(); ++i)
+};
+
+/* s quoted for json, out is any stream of chars */
+template <class Out> void json_string(Out &out, string_view s)
+{
+	out << '"';
+	for (auto c = s.begin(); c != s.end(); ++c)
 	{
-		drawer << i->second->name << "(" << data_type[i->second->type] << ")" << ":" << i->second->bound[0] << i->second->low << "," << i->second->up << i->second->bound[1] << "  ";
+		if (*c == '"' || *c == '\\')
+			out << '\\' << *c;
+		else if ((unsigned char)*c < 0x20)
+		{
+			char hex[8];
+			snprintf(hex, sizeof(hex), "\\u%04x", (unsigned char)*c);
+			out << hex;
+		}
+		else
+			out << *c;
 	}
-	drawer << ")" << endl;
-	drawer << white << "NEXT:(";
-	for (auto i = next.begin(); i != next.end(); ++i)
-		drawer << *i << ",";
-	drawer << ")" << endl;
-	drawer << endl;
+	out << '"';
 }
 
-class FuncTable
+class FuncTable;
+
+class Stats
 {
+	vector<string> functions;	// one json object each, in the order recorded
 public:
-	string func_name;
-	vector<VarTable*> args;
-	map<string, VarTable*> vars;
-	map<string, BlockTable*> blocks;
-	BlockTable* add_block(string bname);
-	void draw(fstream &drawer);
+	long long ns[PH_COUNT] = {};	// parse and load include the phases run inside them
+	bool streamed = false;			// solve and draw ran inside parse or load
+	PHASE outer = PH_PARSE;			// which of them, load for a cached input
+	long long own(PHASE p);
+	void add(FuncTable *f);
+	void write(ostream &out, const string &input);
 };
 
-BlockTable* FuncTable::add_block(string bname)
-{
-	BlockTable *new_blk = new BlockTable(bname);
-	map<string, VarTable*>::iterator i = this->vars.begin();
-	for (; i != this->vars.end(); i++)
-	{
-		new_blk->IN[i->first] = new VarTable(*(i->second));
-		new_blk->OUT[i->first] = new VarTable(*(i->second));
-	}
-	blocks[bname] = new_blk;
-	return new_blk;
-}
+enum DATA_TYPE : uint8_t {INT, FLOAT};
+string data_type[] = { "int", "float" };
+
+enum OP_TYPE {ADD, SUB, MUL, DIV, FLOAT_CAST, INT_CAST, CALL, GOTO_EQ, 
+	GOTO_NE, GOTO_LE, GOTO_GE, GOTO_L, GOTO_G, GOTO, ASSIGN, RETURN};
+string op_type[] = { "add", "sub", "mul", "div", "float_cast", "int_cast", "call", "goto_eq",
+	"goto_ne", "goto_le", "goto_ge", "goto_l", "goto_g", "goto", "assign", "return" };
+const char *op_name[] = { "ADD", "SUB", "MUL", "DIV", "CAST_TO_FLOAT", "CAST_TO_INT", "CALL", "GOTO_EQ",
+	"GOTO_NE", "GOTO_LE", "GOTO_GE", "GOTO_L", "GOTO_G", "GOTO", "ASSIGN", "RETURN" };
+
+/*
+ * names are interned once at parse time, everything after works on dense ids.
+ * an operand is a variable id (>= 0), a constant (~index into the constant
+ * pool of its function) or NO_SYM when absent.
+ */
+typedef int32_t sym_t;
+const sym_t NO_SYM = INT32_MIN;
 
-void FuncTable::draw(fstream &drawer)
+inline bool is_constant(sym_t a)
 {
-	drawer << "**********************************" << endl;
-	drawer << "function: " << func_name << endl;
-	drawer << "parameters: ( ";
-	for (int i = 0; i < args.size(); ++i)
-		drawer << args[i]->name << "(" << data_type[args[i]->type] << ")" << ":" << args[i]->bound[0] << args[i]->low << "," << args[i]->up << args[i]->bound[1] << "  ";
-	drawer << ")" << endl;
-	drawer << "variables: ( ";
-	for (auto i = vars.begin(); i != vars.end(); ++i)
-		drawer << i->first << "(" << data_type[i->second->type] << ")" << ":" << i->second->bound[0] << i->second->low << "," << i->second->up << i->second->bound[1] << "  ";
-	drawer << ")" << endl;
-	drawer << "----------------" << endl;
-	drawer << "blocks:" << endl;
-	for (auto i = blocks.begin(); i != blocks.end(); ++i)
-	{
-		i->second->draw(drawer);
-	}
-	drawer << endl;
-	drawer << endl;
-	
+	return a < 0 && a != NO_SYM;
 }
 
-class GlobalTable
+class SymbolTable
 {
 public:
-	map<string, FuncTable*> funcs;
-	void put(string fname)
-	{
-		FuncTable *tmp = new FuncTable();
-		tmp->func_name = fname;
-		funcs[fname] = tmp;
-	}
-	void draw();
+	deque<string> names;	// a deque never moves its strings, ids view into them
+	unordered_map<string_view, sym_t> ids;
+	sym_t intern(string_view name);
+	sym_t find(string_view name) const;
+	sym_t size() const { return (sym_t)names.size(); }
 };
 
-void GlobalTable::draw()
+sym_t SymbolTable::intern(string_view name)
 {
-	fstream drawer;
-	drawer.open("draw.txt", ios::out);
-	for (auto i = funcs.begin(); i != funcs.end(); i++)
-		i->second->draw(drawer);
+	auto i = ids.find(name);
+	if (i != ids.end())
+		return i->second;
+	sym_t id = size();
+	names.push_back(string(name));
+	ids[string_view(names.back())] = id;
+	return id;
 }
 
-class SSAHandler
+sym_t SymbolTable::find(string_view name) const
 {
-	fstream logger;
-	fstream &file;
-	int p;
-	char ch;
-	char* buffer;
-	string cur_func_name;
-	string cur_block_name;
-	enum STATES {END, GLOBAL, FUNCTION_HEAD, PARAMETER, FUNCTION_BODY};
-	GlobalTable table;
-	stack<STATES> states;
-	int line;
-
-	int nextline();
-	void strip();
-	void passto(char end);
-	void cutid(string &a);
-	void cutnumber(string &a);
-	void cut(string &a);
-	void pruneid(string &a);
-	void parse_parameter();
-	void parse_function_head();
-	void parse_statement();
-	void parse_goto(string &a);
+	auto i = ids.find(name);
+	if (i == ids.end())
+		return NO_SYM;
+	return i->second;
+}
 
-public:
-	SSAHandler(fstream &_file) : file(_file) 
+/*
+ * bump allocator for the ir of one function. nodes are never freed one by
+ * one, the whole arena is released at once together with its function.
+ */
+class Arena
+{
+	struct Chunk
 	{
-		p = 0;
-		buffer = new char[1024];
-		buffer[0] = '\0';
-		states.push(END);
-		cur_func_name = "0";
-		cur_block_name = "0";
-		line = 0;
-		logger.open("log.txt", ios::out);
-	}
-	~SSAHandler()
+		Chunk *prev;
+		size_t size;
+		size_t used;
+	};
+	struct Finalizer
 	{
-		delete[]buffer;
+		void (*run)(void*);
+		void *obj;
+		Finalizer *prev;
+	};
+	Chunk *head;
+	Finalizer *finalizers;
+	size_t chunk_size;
+	void grow(size_t need);
+public:
+	size_t allocated;		// bytes handed out
+	size_t nodes;			// objects made
+	Arena(size_t _chunk_size = 64 * 1024) : head(nullptr), finalizers(nullptr), chunk_size(_chunk_size), allocated(0), nodes(0) {}
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena()
+	{
+		release();
 	}
-	void parse(bool draw = false);
-	
+	void* alloc(size_t size, size_t align);
+	template <class T, class... Args> T* make(Args&&... args);
+	void release();
 };
 
-void SSAHandler::cutid(string &a)
+void Arena::grow(size_t need)
 {
-	char name[100];		// FIXME: name may be longer than 100
-	int pname = 0;
-	int count = 0;
-	while ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch == '_') || (ch == '.') || (ch == '(')
-		|| (ch == ')') || (ch >= '0' && ch <= '9'))
-	{
-		if (ch == '(')
-			count++;
-		if (ch == ')')
-		{
-			if (count > 0)
-				count--;
-			else
-				break;
-		}
-		name[pname++] = ch;
-		ch = buffer[p++];
-	}
-	name[pname] = '\0';
-	a = string(name);
+	size_t size = max(chunk_size, need);
+	Chunk *c = (Chunk*)malloc(sizeof(Chunk) + size);
+	if (c == nullptr)
+		throw bad_alloc();
+	c->prev = head;
+	c->size = size;
+	c->used = 0;
+	head = c;
 }
 
-void SSAHandler::cutnumber(string &a)
+void* Arena::alloc(size_t size, size_t align)
 {
-	char number[100];
-	int pnumber = 0;
-	number[pnumber++] = ch;
-	ch = buffer[p++];
-	while ((ch >= '0' && ch <= '9') || (ch == '.'))
-	{
-		number[pnumber++] = ch;
-		ch = buffer[p++];
-	}
-	if (ch == 'e' || ch == 'E')
+	uintptr_t base, at;
+	if (head != nullptr)
 	{
-		number[pnumber++] = ch;
-		ch = buffer[p++];
-		if (ch == '-' || ch == '+')
-		{
-			number[pnumber++] = ch;
-			ch = buffer[p++];
-		}
-		while (ch >= '0' && ch <= '9')
+		base = (uintptr_t)(head + 1);
+		at = (base + head->used + align - 1) & ~(uintptr_t)(align - 1);
+		if (at + size <= base + head->size)
 		{
-			number[pnumber++] = ch;
-			ch = buffer[p++];
+			head->used = at + size - base;
+			allocated += size;
+			return (void*)at;
 		}
 	}
-	number[pnumber] = '\0';
-	a = string(number);
+	grow(size + align);
+	base = (uintptr_t)(head + 1);
+	at = (base + align - 1) & ~(uintptr_t)(align - 1);
+	head->used = at + size - base;
+	allocated += size;
+	return (void*)at;
 }
 
-void SSAHandler::cut(string &a)
+template <class T, class... Args>
+T* Arena::make(Args&&... args)
 {
-	if (ch == '-' || ch == '+' || (ch >= '0' && ch <= '9'))
-	{
-		/* again a number */
-		cutnumber(a);
-		return;
-	}
-	else if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_')
+	T *obj = new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	nodes++;
+	if (!is_trivially_destructible<T>::value)
 	{
-		/* this should be a variable */
-		cutid(a);
-		pruneid(a);
-		return;
+		/* nodes holding containers are destroyed on release */
+		Finalizer *f = (Finalizer*)alloc(sizeof(Finalizer), alignof(Finalizer));
+		f->run = [](void *p) { ((T*)p)->~T(); };
+		f->obj = obj;
+		f->prev = finalizers;
+		finalizers = f;
 	}
+	return obj;
 }
 
-void SSAHandler::pruneid(string &a)
+void Arena::release()
 {
-	if (table.funcs[cur_func_name]->vars.find(a) != table.funcs[cur_func_name]->vars.end())
-		return;
-	size_t p_ = string::npos;
-	/* TODO: what if the subscript useful? */
-	if ((p_ = a.find_last_of('_')) != string::npos && p_ != 0)
+	for (Finalizer *f = finalizers; f != nullptr; f = f->prev)
+		f->run(f->obj);
+	finalizers = nullptr;
+	while (head != nullptr)
 	{
-		a = a.substr(0, p_);
+		Chunk *c = head->prev;
+		free(head);
+		head = c;
 	}
+	allocated = 0;
+	nodes = 0;
 }
 
-int SSAHandler::nextline()
+/*
+ * the statements of a function are fixed size records in one stream,
+ * FuncTable::code, and each block is a range of it. the arguments of a
+ * CALL are a range of FuncTable::operands.
+ */
+class Instr
 {
-	if (file.eof())
-		return -1;
-	p = 0;
-	file.getline(buffer, 1024);
-	line++;
-	ch = buffer[p++];
-	return 0;
-}
+public:
+	OP_TYPE op;
+	sym_t result = NO_SYM;
+	sym_t arg1 = NO_SYM;		// the callee of a CALL, an id in GlobalTable::names
+	sym_t arg2 = NO_SYM;
+	int32_t first = 0;			// arguments of a CALL
+	int32_t count = 0;
+};
 
-void SSAHandler::strip()
+/*
+ * results are written through an Emitter, into a buffer of its own that
+ * goes out in large writes, with numbers formatted by to_chars. text is
+ * the layout below, json one line per function, binary one record per
+ * function after a file header. filters keep only the functions and
+ * variables named; empty filters keep everything.
+ */
+enum FORMAT {FMT_TEXT, FMT_JSON, FMT_BINARY};
+
+class EmitOptions
 {
-	if (ch == '\0')
+public:
+	FORMAT format = FMT_TEXT;
+	unordered_set<string> funcs;
+	unordered_set<string> vars;
+	bool keeps_func(const string &name) const
 	{
-		if (nextline() < 0)
-		{
-			global_error.set(SYNTEXT_ERROR, string("unexpected end of file"), line);
-			global_error.give_msg();
-			return;
-		}
+		return funcs.empty() || funcs.count(name) > 0;
 	}
-	while (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+	bool keeps_var(const string &name) const
 	{
-		ch = buffer[p++];
-		if (ch == '\0')
-		{
-			if (nextline() < 0)
-			{
-				global_error.set(SYNTEXT_ERROR, string("unexpected end of file"), line);
-				global_error.give_msg();
-				return;
-			}
-		}
+		return vars.empty() || vars.count(name) > 0;
 	}
-}
-
-void SSAHandler::passto(char end)
-{
-	while (ch != end)
+	bool plain() const
 	{
-		ch = buffer[p++];
-		if (ch == '\0')
-		{
-			if (nextline() < 0)
-			{
-				string msg("miss ");
-				msg.push_back(end);
-				global_error.set(SYNTEXT_ERROR, msg, line);
-				global_error.give_msg();
-				return;
-			}
-		}
+		return format == FMT_TEXT && funcs.empty() && vars.empty();
 	}
-}
-
-void SSAHandler::parse_parameter()
-{
-	while (ch != ')')
+	const char* extension() const
 	{
-		string sname;
-		string stype;
-		cut(stype);
-		strip();
-		cut(sname);
-		strip();
-		if (ch == ',')
-			ch = buffer[p++];
-		strip();
-
-		DATA_TYPE dtype = INT;
-		if (stype == "float")
-			dtype = FLOAT;
-
-		VarTable *tmp = new VarTable(sname, dtype);
-		table.funcs[cur_func_name]->args.push_back(tmp);
-		table.funcs[cur_func_name]->vars[sname] = new VarTable(*tmp);
+		static const char *ext[] = { ".range", ".jsonl", ".rbin" };
+		return ext[format];
 	}
-	return;
-}
+};
 
-void SSAHandler::parse_function_head()
+/*
+ * binary results, in host byte order: the magic and a u32 version, then per
+ * function its name, parameters as (name, range), a u8 flag and the return
+ * range, variables as (name, range), and per block its name and the IN and
+ * OUT range of each variable, in the order of the variables. a name is a
+ * u32 length and its bytes; a range is u8 type, u8 flags (1 empty, 2 low
+ * open, 4 up open), f64 low and f64 up; counts are u32. results of
+ * --scenarios are version 2, a record per function and scenario: the name,
+ * the u32 scenario, parameters, flag and return, and variables as above.
+ * answers to --query are version 3, a record per query: the function, block
+ * and variable names and the range.
+ */
+const char RESULT_MAGIC[8] = {'S', 'S', 'A', 'R', 'A', 'N', 'G', 'E'};
+const uint32_t RESULT_VERSION = 1;
+const uint32_t SCENARIO_VERSION = 2;
+const uint32_t QUERY_VERSION = 3;
+
+class Emitter
 {
-	char name[100];		//name may be longer than 100
-	int pname = 0;
-	while ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch == '_') || (ch >= '0' && ch <= '9'))
+	ostream *out;		// nullptr keeps everything in buf
+	static const size_t flush_at = 1 << 20;
+public:
+	const EmitOptions &options;
+	string buf;
+	Emitter(const EmitOptions &_options, ostream *_out = nullptr) : out(_out), options(_options) {}
+	Emitter(const Emitter&) = delete;
+	Emitter& operator=(const Emitter&) = delete;
+	~Emitter()
 	{
-		name[pname++] = ch;
-		ch = buffer[p++];
+		flush();
 	}
-	name[pname] = '\0';
-	string fname = string(name);
-	table.put(fname);
-	/* record function name in process */
-	cur_func_name = fname;
-	while (ch == ' ' || ch == '\t')
-		ch = buffer[p++];
-	if (ch != '(')
+	Emitter& operator<<(string_view s)
 	{
-		global_error.set(SYNTEXT_ERROR, string("[ERROR] no '(' at function head ") + fname, line);
-		global_error.give_msg();
-		return;
+		buf.append(s.data(), s.size());
+		return *this;
 	}
-	/* in state of handle parameters */
-	states.push(PARAMETER);
-	ch = buffer[p++];
-	while (ch == ' ' || ch == '\t')
-		ch = buffer[p++];
-	parse_parameter();
-	while (ch == ' ' || ch == '\t')
-		ch = buffer[p++];
-	if (ch != ')')
+	Emitter& operator<<(char c)
 	{
-		global_error.set(SYNTEXT_ERROR, string("[ERROR] no ')' at function head ").append(name), line);
-		global_error.give_msg();
-		return;
+		buf.push_back(c);
+		return *this;
 	}
-	/* out state of handle parameter */
-	states.pop();
-	ch = buffer[p++];
-	return;
+	Emitter& operator<<(double v);
+	Emitter& exact(double v);
+	template <class T> typename enable_if<is_integral<T>::value, Emitter&>::type operator<<(T v)
+	{
+		char num[24];
+		buf.append(num, to_chars(num, num + sizeof(num), v).ptr - num);
+		return *this;
+	}
+	template <class T> void raw(const T &v)
+	{
+		buf.append((const char*)&v, sizeof(T));
+	}
+	void name(string_view s);
+	void header(uint32_t version = RESULT_VERSION);
+	/* at the end of a function, so a flush never splits one */
+	void done()
+	{
+		if (buf.size() >= flush_at)
+			flush();
+	}
+	void flush()
+	{
+		if (out == nullptr || buf.empty())
+			return;
+		out->write(buf.data(), buf.size());
+		buf.clear();
+	}
+};
+
+Emitter& Emitter::operator<<(double v)
+{
+	/* as iostream prints by default, %g of 6 digits */
+	char num[32];
+	buf.append(num, to_chars(num, num + sizeof(num), v, chars_format::general, 6).ptr - num);
+	return *this;
 }
 
-void SSAHandler::parse_goto(string &a)
+/* the shortest text that reads back as v, null for an infinity as json has none */
+Emitter& Emitter::exact(double v)
 {
-	if (ch == '<')
+	if (isinf(v))
+		return *this << "null";
+	char num[32];
+	buf.append(num, to_chars(num, num + sizeof(num), v).ptr - num);
+	return *this;
+}
+
+/* a binary name, its u32 length and bytes */
+void Emitter::name(string_view s)
+{
+	raw((uint32_t)s.size());
+	*this << s;
+}
+
+/* what starts a file of results */
+void Emitter::header(uint32_t version)
+{
+	if (options.format != FMT_BINARY)
+		return;
+	buf.append(RESULT_MAGIC, sizeof(RESULT_MAGIC));
+	raw(version);
+}
+
+class VarTable
+{
+public:
+	sym_t id;
+	DATA_TYPE type;
+	char bound[2];		// '(' or '[', ')' or ']'
+	double low, up;
+	VarTable(sym_t _id, DATA_TYPE _type, double _low= -INFINITY, double _up = INFINITY, char low_bound = '[', char up_bound = ']')
+	{
+		id = _id;
+		type = _type;
+		low = _low;
+		up = _up;
+		bound[0] = low_bound;
+		bound[1] = up_bound;
+	}
+	VarTable() : id(NO_SYM), type(INT), low(INFINITY), up(-INFINITY)
+	{
+		bound[0] = '[';
+		bound[1] = ']';
+	}
+	/* interval operations, an empty range is kept as low > up */
+	bool empty() const;
+	void set_empty();
+	void set_full();
+	void set(double _low, double _up, char low_bound = '[', char up_bound = ']');
+	void fit();
+	bool same(const VarTable &other) const;
+	void copy_range(const VarTable &other);
+	void join(const VarTable &other);
+	void meet(const VarTable &other);
+	void widen(const VarTable &other, const vector<double> *steps = nullptr);
+	void narrow(const VarTable &other, const vector<double> *steps = nullptr);
+	void draw(Emitter &drawer, const string &name) const;
+	void emit(Emitter &e) const;
+};
+
+bool VarTable::empty() const
+{
+	if (low > up)
+		return true;
+	return low == up && (bound[0] == '(' || bound[1] == ')');
+}
+
+void VarTable::set_empty()
+{
+	set(INFINITY, -INFINITY);
+}
+
+void VarTable::set_full()
+{
+	set(-INFINITY, INFINITY);
+}
+
+void VarTable::set(double _low, double _up, char low_bound, char up_bound)
+{
+	low = _low;
+	up = _up;
+	bound[0] = low_bound;
+	bound[1] = up_bound;
+	fit();
+}
+
+void VarTable::fit()
+{
+	/* infinite ends are always printed closed, as the declarations are */
+	if (std::isinf(low))
+		bound[0] = '[';
+	if (std::isinf(up))
+		bound[1] = ']';
+	if (type == INT)
+	{
+		/* integers only take whole values, so every end can be closed */
+		if (!std::isinf(low))
+		{
+			double c = ceil(low);
+			if (c == low && bound[0] == '(')
+				c += 1;
+			low = c;
+			bound[0] = '[';
+		}
+		if (!std::isinf(up))
+		{
+			double f = floor(up);
+			if (f == up && bound[1] == ')')
+				f -= 1;
+			up = f;
+			bound[1] = ']';
+		}
+	}
+	if (empty())
+	{
+		low = INFINITY;
+		up = -INFINITY;
+		bound[0] = '[';
+		bound[1] = ']';
+	}
+}
+
+bool VarTable::same(const VarTable &other) const
+{
+	if (empty() || other.empty())
+		return empty() == other.empty();
+	return low == other.low && up == other.up && bound[0] == other.bound[0] && bound[1] == other.bound[1];
+}
+
+void VarTable::copy_range(const VarTable &other)
+{
+	low = other.low;
+	up = other.up;
+	bound[0] = other.bound[0];
+	bound[1] = other.bound[1];
+}
+
+void VarTable::join(const VarTable &other)
+{
+	if (other.empty())
+		return;
+	if (empty())
+	{
+		copy_range(other);
+		return;
+	}
+	if (other.low < low || (other.low == low && other.bound[0] == '['))
+	{
+		low = other.low;
+		bound[0] = other.bound[0];
+	}
+	if (other.up > up || (other.up == up && other.bound[1] == ']'))
+	{
+		up = other.up;
+		bound[1] = other.bound[1];
+	}
+}
+
+void VarTable::meet(const VarTable &other)
+{
+	if (empty())
+		return;
+	if (other.empty())
+	{
+		set_empty();
+		return;
+	}
+	if (other.low > low || (other.low == low && other.bound[0] == '('))
+	{
+		low = other.low;
+		bound[0] = other.bound[0];
+	}
+	if (other.up < up || (other.up == up && other.bound[1] == ')'))
+	{
+		up = other.up;
+		bound[1] = other.bound[1];
+	}
+	fit();
+}
+
+void VarTable::widen(const VarTable &other, const vector<double> *steps)
+{
+	/* any end still moving is pushed out to the next of steps past it, or
+	 * to infinity when there is none. steps is sorted, nullptr for none */
+	if (empty())
+	{
+		copy_range(other);
+		return;
+	}
+	if (other.empty())
+		return;
+	if (other.low < low || (other.low == low && bound[0] == '(' && other.bound[0] == '['))
+	{
+		low = -INFINITY;
+		bound[0] = '[';
+		if (steps != nullptr)
+		{
+			auto t = upper_bound(steps->begin(), steps->end(), other.low);
+			if (t != steps->begin())
+				low = *(t - 1);
+		}
+	}
+	if (other.up > up || (other.up == up && bound[1] == ')' && other.bound[1] == ']'))
+	{
+		up = INFINITY;
+		bound[1] = ']';
+		if (steps != nullptr)
+		{
+			auto t = lower_bound(steps->begin(), steps->end(), other.up);
+			if (t != steps->end())
+				up = *t;
+		}
+	}
+	fit();
+}
+
+void VarTable::narrow(const VarTable &other, const vector<double> *steps)
+{
+	/* only the ends lost to widening are taken back, those at infinity or
+	 * on one of the steps widening stopped at */
+	if (other.empty())
+	{
+		set_empty();
+		return;
+	}
+	if (empty())
+		return;
+	auto lost = [steps](double end) {
+		return std::isinf(end) || (steps != nullptr && binary_search(steps->begin(), steps->end(), end));
+	};
+	if (lost(low) && (other.low > low || (other.low == low && other.bound[0] == '(')))
+	{
+		low = other.low;
+		bound[0] = other.bound[0];
+	}
+	if (lost(up) && (other.up < up || (other.up == up && other.bound[1] == ')')))
+	{
+		up = other.up;
+		bound[1] = other.bound[1];
+	}
+	fit();
+}
+
+void VarTable::draw(Emitter &drawer, const string &name) const
+{
+	drawer << name << "(" << data_type[type] << ")" << ":";
+	if (empty())
+		drawer << "empty";
+	else
+		drawer << bound[0] << low << "," << up << bound[1];
+	drawer << "  ";
+}
+
+/* the range alone, as json or binary by the format of e */
+void VarTable::emit(Emitter &e) const
+{
+	if (e.options.format == FMT_BINARY)
+	{
+		e.raw((uint8_t)type);
+		e.raw((uint8_t)(empty() + 2 * (bound[0] == '(') + 4 * (bound[1] == ')')));
+		e.raw(low);
+		e.raw(up);
+		return;
+	}
+	e << "{\"type\": \"" << data_type[type] << "\"";
+	if (empty())
+	{
+		e << ", \"empty\": true}";
+		return;
+	}
+	e << ", \"low\": ";
+	e.exact(low) << ", \"up\": ";
+	e.exact(up) << ", \"bounds\": \"" << bound[0] << bound[1] << "\"}";
+}
+
+/*
+ * persistent environment of ranges, indexed by var id. it is a tree of
+ * ENV_WIDTH-way nodes shared between environments and copied on write, so
+ * a block only pays for the leaves it changes, and joins or compares skip
+ * every subtree two environments still share. a null node stands for vars
+ * that are all bottom.
+ */
+const int ENV_SHIFT = 4;
+const int ENV_WIDTH = 1 << ENV_SHIFT;
+const int ENV_MASK = ENV_WIDTH - 1;
+
+class EnvNode
+{
+public:
+	int refs;
+};
+
+class EnvInner : public EnvNode
+{
+public:
+	EnvNode *kids[ENV_WIDTH];
+};
+
+class EnvLeaf : public EnvNode
+{
+public:
+	VarTable slots[ENV_WIDTH];
+};
+
+class EnvPool
+{
+	Arena &arena;
+	vector<EnvInner*> free_inner;
+	vector<EnvLeaf*> free_leaf;
+public:
+	vector<VarTable> proto;		// bottom value of each var, for slots never written
+	size_t live;				// nodes in use
+	EnvPool(Arena &_arena) : arena(_arena), live(0) {}
+	EnvInner* inner();
+	EnvLeaf* leaf(sym_t first);
+	EnvNode* clone(EnvNode *n, int height);
+	void ref(EnvNode *n)
+	{
+		if (n != nullptr)
+			n->refs++;
+	}
+	void unref(EnvNode *n, int height);
+};
+
+EnvInner* EnvPool::inner()
+{
+	EnvInner *n;
+	if (free_inner.empty())
+		n = arena.make<EnvInner>();
+	else
+	{
+		n = free_inner.back();
+		free_inner.pop_back();
+	}
+	n->refs = 1;
+	for (int k = 0; k < ENV_WIDTH; ++k)
+		n->kids[k] = nullptr;
+	live++;
+	return n;
+}
+
+EnvLeaf* EnvPool::leaf(sym_t first)
+{
+	EnvLeaf *n;
+	if (free_leaf.empty())
+		n = arena.make<EnvLeaf>();
+	else
+	{
+		n = free_leaf.back();
+		free_leaf.pop_back();
+	}
+	n->refs = 1;
+	for (int k = 0; k < ENV_WIDTH; ++k)
+		n->slots[k] = (first + k < proto.size()) ? proto[first + k] : VarTable();
+	live++;
+	return n;
+}
+
+EnvNode* EnvPool::clone(EnvNode *n, int height)
+{
+	if (height == 0)
+	{
+		EnvLeaf *c = leaf(0);
+		for (int k = 0; k < ENV_WIDTH; ++k)
+			c->slots[k] = ((EnvLeaf*)n)->slots[k];
+		return c;
+	}
+	EnvInner *c = inner();
+	for (int k = 0; k < ENV_WIDTH; ++k)
+	{
+		c->kids[k] = ((EnvInner*)n)->kids[k];
+		ref(c->kids[k]);
+	}
+	return c;
+}
+
+void EnvPool::unref(EnvNode *n, int height)
+{
+	if (n == nullptr || --n->refs > 0)
+		return;
+	live--;
+	if (height == 0)
+	{
+		free_leaf.push_back((EnvLeaf*)n);
+		return;
+	}
+	EnvInner *in = (EnvInner*)n;
+	for (int k = 0; k < ENV_WIDTH; ++k)
+		unref(in->kids[k], height - 1);
+	free_inner.push_back(in);
+}
+
+class Env
+{
+	enum MERGE {JOIN, WIDEN, NARROW};
+	EnvPool *pool;
+	EnvNode *root;
+	sym_t count;
+	int height;			// of root, 0 when root is a leaf
+	EnvNode* merge(EnvNode *a, EnvNode *b, int h, MERGE op, const vector<double> *steps);
+	bool same_node(EnvNode *a, EnvNode *b, int h) const;
+	bool bottom_node(EnvNode *n, int h) const;
+	void apply(const Env &other, MERGE op, const vector<double> *steps = nullptr);
+public:
+	Env() : pool(nullptr), root(nullptr), count(0), height(0) {}
+	Env(EnvPool *_pool, sym_t _count);
+	Env(const Env &other);
+	Env& operator=(const Env &other);
+	~Env();
+	sym_t size() const { return count; }
+	const VarTable& get(sym_t i) const;
+	VarTable& mut(sym_t i);
+	void clear();
+	bool same(const Env &other) const;
+	void join(const Env &other) { apply(other, JOIN); }
+	void widen(const Env &other, const vector<double> *steps = nullptr) { apply(other, WIDEN, steps); }
+	void narrow(const Env &other, const vector<double> *steps = nullptr) { apply(other, NARROW, steps); }
+};
+
+Env::Env(EnvPool *_pool, sym_t _count) : pool(_pool), root(nullptr), count(_count), height(0)
+{
+	for (sym_t span = ENV_WIDTH; span < count; span <<= ENV_SHIFT)
+		height++;
+}
+
+Env::Env(const Env &other) : pool(other.pool), root(other.root), count(other.count), height(other.height)
+{
+	if (pool != nullptr)
+		pool->ref(root);
+}
+
+Env& Env::operator=(const Env &other)
+{
+	if (other.pool != nullptr)
+		other.pool->ref(other.root);
+	if (pool != nullptr)
+		pool->unref(root, height);
+	pool = other.pool;
+	root = other.root;
+	count = other.count;
+	height = other.height;
+	return *this;
+}
+
+Env::~Env()
+{
+	if (pool != nullptr)
+		pool->unref(root, height);
+}
+
+const VarTable& Env::get(sym_t i) const
+{
+	EnvNode *n = root;
+	for (int h = height; n != nullptr && h > 0; --h)
+		n = ((EnvInner*)n)->kids[(i >> (ENV_SHIFT * h)) & ENV_MASK];
+	if (n == nullptr)
+		return pool->proto[i];
+	return ((EnvLeaf*)n)->slots[i & ENV_MASK];
+}
+
+VarTable& Env::mut(sym_t i)
+{
+	/* copy the path down to var i wherever it is still shared */
+	EnvNode **slot = &root;
+	for (int h = height; ; --h)
+	{
+		EnvNode *n = *slot;
+		if (n == nullptr)
+			n = h ? (EnvNode*)pool->inner() : (EnvNode*)pool->leaf(i & ~ENV_MASK);
+		else if (n->refs > 1)
+		{
+			n->refs--;
+			n = pool->clone(n, h);
+		}
+		*slot = n;
+		if (h == 0)
+			return ((EnvLeaf*)n)->slots[i & ENV_MASK];
+		slot = &((EnvInner*)n)->kids[(i >> (ENV_SHIFT * h)) & ENV_MASK];
+	}
+}
+
+void Env::clear()
+{
+	pool->unref(root, height);
+	root = nullptr;
+}
+
+bool Env::bottom_node(EnvNode *n, int h) const
+{
+	if (n == nullptr)
+		return true;
+	for (int k = 0; k < ENV_WIDTH; ++k)
+	{
+		if (h == 0 && !((EnvLeaf*)n)->slots[k].empty())
+			return false;
+		if (h > 0 && !bottom_node(((EnvInner*)n)->kids[k], h - 1))
+			return false;
+	}
+	return true;
+}
+
+bool Env::same_node(EnvNode *a, EnvNode *b, int h) const
+{
+	if (a == b)
+		return true;
+	if (a == nullptr)
+		return bottom_node(b, h);
+	if (b == nullptr)
+		return bottom_node(a, h);
+	for (int k = 0; k < ENV_WIDTH; ++k)
+	{
+		if (h == 0 && !((EnvLeaf*)a)->slots[k].same(((EnvLeaf*)b)->slots[k]))
+			return false;
+		if (h > 0 && !same_node(((EnvInner*)a)->kids[k], ((EnvInner*)b)->kids[k], h - 1))
+			return false;
+	}
+	return true;
+}
+
+bool Env::same(const Env &other) const
+{
+	return same_node(root, other.root, height);
+}
+
+EnvNode* Env::merge(EnvNode *a, EnvNode *b, int h, MERGE op, const vector<double> *steps)
+{
+	/* returns a new reference to a op b, reusing a or b when possible */
+	if (a == b || (b == nullptr && op != NARROW))
+	{
+		pool->ref(a);
+		return a;
+	}
+	if (b == nullptr || (a == nullptr && op == NARROW))
+		return nullptr;
+	if (a == nullptr)
+	{
+		pool->ref(b);
+		return b;
+	}
+	if (h == 0)
+	{
+		EnvLeaf *x = (EnvLeaf*)a, *y = (EnvLeaf*)b, *out = nullptr;
+		for (int k = 0; k < ENV_WIDTH; ++k)
+		{
+			VarTable v = x->slots[k];
+			if (op == JOIN)
+				v.join(y->slots[k]);
+			else if (op == WIDEN)
+				v.widen(y->slots[k], steps);
+			else
+				v.narrow(y->slots[k], steps);
+			if (v.same(x->slots[k]))
+				continue;
+			if (out == nullptr)
+				out = (EnvLeaf*)pool->clone(x, 0);
+			out->slots[k] = v;
+		}
+		if (out == nullptr)
+		{
+			pool->ref(a);
+			return a;
+		}
+		return out;
+	}
+	EnvInner *x = (EnvInner*)a, *y = (EnvInner*)b;
+	EnvNode *kids[ENV_WIDTH];
+	bool as_a = true, as_b = true;
+	for (int k = 0; k < ENV_WIDTH; ++k)
+	{
+		kids[k] = merge(x->kids[k], y->kids[k], h - 1, op, steps);
+		as_a = as_a && kids[k] == x->kids[k];
+		as_b = as_b && kids[k] == y->kids[k];
+	}
+	if (as_a || as_b)
+	{
+		for (int k = 0; k < ENV_WIDTH; ++k)
+			pool->unref(kids[k], h - 1);
+		EnvNode *keep = as_a ? a : b;
+		pool->ref(keep);
+		return keep;
+	}
+	EnvInner *out = pool->inner();
+	for (int k = 0; k < ENV_WIDTH; ++k)
+		out->kids[k] = kids[k];
+	return out;
+}
+
+void Env::apply(const Env &other, MERGE op, const vector<double> *steps)
+{
+	EnvNode *n = merge(root, other.root, height, op, steps);
+	pool->unref(root, height);
+	root = n;
+}
+
+class BlockTable
+{
+public:
+	sym_t id;
+	Env IN;
+	Env OUT;
+	int first = 0;			// its statements, a range of FuncTable::code
+	int count = 0;
+	vector<sym_t> next;
+	vector<sym_t> pre;
+	BlockTable(sym_t _id)
+	{
+		id = _id;
+	}
+	void draw(Emitter &drawer, FuncTable &func, const vector<sym_t> &shown, const SymbolTable &callees, int indent = 4);
+};
+
+/*
+ * adjacency in compressed rows: row i is edges[start[i]] up to
+ * edges[start[i + 1]], so walking the edges of a block is one array walk
+ */
+class EdgeRows
+{
+public:
+	vector<int> start;
+	vector<int> edges;
+	class Row
+	{
+	public:
+		const int *first;
+		const int *last;
+		const int* begin() const { return first; }
+		const int* end() const { return last; }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+		int operator[](size_t k) const { return first[k]; }
+	};
+	Row operator[](int i) const { return Row{edges.data() + start[i], edges.data() + start[i + 1]}; }
+	void fill(int rows, const vector<pair<int, int>> &pairs, bool reverse);
+	void clear();
+};
+
+/* rows from (from, to) pairs, by to when reverse. pairs keep their order within a row */
+void EdgeRows::fill(int rows, const vector<pair<int, int>> &pairs, bool reverse)
+{
+	start.assign(rows + 1, 0);
+	for (auto p = pairs.begin(); p != pairs.end(); ++p)
+		start[(reverse ? p->second : p->first) + 1]++;
+	for (int i = 0; i < rows; ++i)
+		start[i + 1] += start[i];
+	edges.resize(pairs.size());
+	vector<int> at(start.begin(), start.end() - 1);
+	for (auto p = pairs.begin(); p != pairs.end(); ++p)
+	{
+		if (reverse)
+			edges[at[p->second]++] = p->first;
+		else
+			edges[at[p->first]++] = p->second;
+	}
+}
+
+void EdgeRows::clear()
+{
+	start.clear();
+	edges.clear();
+}
+
+/*
+ * the flow graph of a function as the solvers walk it, built once when the
+ * function is complete and shared by every solve of it. the blocks reachable
+ * from the entry are numbered in a weak topological order: reverse postorder
+ * with the body of each loop kept right after its header, so a worklist that
+ * takes the lowest index first settles an inner loop before it goes on with
+ * the loop around it
+ */
+class FlowGraph
+{
+public:
+	vector<BlockTable*> order;
+	vector<int> index;			// by block id, its place in order, -1 when left out
+	EdgeRows succ;				// by order index
+	EdgeRows pred;
+	vector<int> idom;			// immediate dominator, the entry is its own
+	vector<int> loop;			// header of the innermost loop holding it, -1 outside loops
+	vector<int> depth;			// loops holding it
+	vector<bool> header;		// targets of back edges, the only places we widen
+	vector<double> thresholds;	// sorted, where widening stops before infinity
+	int loops = 0;
+	int irreducible = 0;		// retreating edges to a block not dominating their source
+	int unreachable = 0;		// defined blocks left out, no path of guards that can hold reaches them
+	bool build(FuncTable *func);
+	void propagate(FuncTable *func, vector<bool> &closed);
+	void gather(FuncTable *func);
+};
+
+class FuncTable
+{
+public:
+	Arena arena;		// owns every statement, block and variable below
+	EnvPool envs;		// nodes of the IN and OUT environments of blocks
+	string func_name;
+	SymbolTable var_names;
+	SymbolTable block_names;
+	SymbolTable const_names;
+	vector<sym_t> args;
+	vector<VarTable*> vars;		// by var id, nullptr for names never declared
+	vector<VarTable> consts;	// by constant index
+	vector<BlockTable*> blocks;	// by block id, nullptr for labels never defined
+	sym_t entry = NO_SYM;
+	VarTable *ret = nullptr;
+	int line = 0;				// of the function head
+	vector<myError> errors;		// found while solving, reported in function order
+	/* what solving it cost, summed over the solves of its scc */
+	long long pops = 0;
+	int widenings = 0;
+	int narrowings = 0;
+	bool approximate = false;	// a budget cut a solve of it short
+	vector<int> visits;			// by block id
+	vector<Instr> code;			// statements, a block at a time
+	vector<sym_t> operands;		// arguments of the calls in code
+	FlowGraph flow;				// of blocks, built once they are all wired
+	sym_t var(string_view name);
+	sym_t block(string_view name);
+	sym_t constant(string_view spelling);
+	VarTable* declare(string_view name, DATA_TYPE type);
+	void ran_out(long long iterations);
+	BlockTable* add_block(sym_t bid);
+	void append(BlockTable *blk, const Instr &s);
+	void compact();
+	string spell(sym_t a);
+	void draw(Emitter &drawer, const SymbolTable &callees);
+	void emit(Emitter &e, const vector<sym_t> &shown, const vector<sym_t> &order);
+	sym_t id = NO_SYM;			// in the names of its GlobalTable
+	FuncTable() : envs(arena) {}
+	~FuncTable()
+	{
+		/* blocks hand their environments back to envs while it is alive */
+		arena.release();
+	}
+};
+
+sym_t FuncTable::var(string_view name)
+{
+	sym_t id = var_names.intern(name);
+	if (id == vars.size())
+		vars.push_back(nullptr);
+	return id;
+}
+
+sym_t FuncTable::block(string_view name)
+{
+	sym_t id = block_names.intern(name);
+	if (id == blocks.size())
+		blocks.push_back(nullptr);
+	return id;
+}
+
+sym_t FuncTable::constant(string_view spelling)
+{
+	sym_t k = const_names.intern(spelling);
+	if (k == consts.size())
+	{
+		double v = strtod(const_names.names[k].c_str(), nullptr);
+		DATA_TYPE t = (spelling.find_first_of(".eE") == string_view::npos) ? INT : FLOAT;
+		consts.push_back(VarTable(~k, t, v, v));
+	}
+	return ~k;
+}
+
+VarTable* FuncTable::declare(string_view name, DATA_TYPE type)
+{
+	sym_t id = var(name);
+	vars[id] = arena.make<VarTable>(id, type);
+	return vars[id];
+}
+
+/* a solve ran out of its budget after iterations, reported once however often it is solved */
+void FuncTable::ran_out(long long iterations)
+{
+	if (approximate)
+		return;
+	approximate = true;
+	errors.push_back(myError(BUDGET_WARNING, string("function ") + func_name + " ran out of budget after "
+		+ to_string(iterations) + " iterations, its loops were widened to infinity", line));
+}
+
+BlockTable* FuncTable::add_block(sym_t bid)
+{
+	BlockTable *new_blk = arena.make<BlockTable>(bid);
+	/* the first block of a function is where control enters */
+	if (entry == NO_SYM)
+		entry = bid;
+	blocks[bid] = new_blk;
+	return new_blk;
+}
+
+void FuncTable::append(BlockTable *blk, const Instr &s)
+{
+	/* a block grows in place while it ends the stream, else it moves to the end */
+	if (blk->first + blk->count != code.size())
+	{
+		int from = blk->first;
+		blk->first = code.size();
+		for (int i = 0; i < blk->count; ++i)
+		{
+			Instr moved = code[from + i];
+			code.push_back(moved);
+		}
+	}
+	code.push_back(s);
+	blk->count++;
+}
+
+/* drops what moved blocks left behind, once the function is parsed */
+void FuncTable::compact()
+{
+	vector<BlockTable*> live;
+	size_t used = 0;
+	for (auto b = blocks.begin(); b != blocks.end(); ++b)
+		if (*b != nullptr)
+		{
+			live.push_back(*b);
+			used += (*b)->count;
+		}
+	if (used == code.size())
+		return;
+	sort(live.begin(), live.end(), [](BlockTable *x, BlockTable *y) { return x->first < y->first; });
+	vector<Instr> packed;
+	packed.reserve(used);
+	for (auto b = live.begin(); b != live.end(); ++b)
+	{
+		int from = (*b)->first;
+		(*b)->first = packed.size();
+		packed.insert(packed.end(), code.begin() + from, code.begin() + from + (*b)->count);
+	}
+	code.swap(packed);
+}
+
+string FuncTable::spell(sym_t a)
+{
+	if (a == NO_SYM)
+		return string();
+	if (is_constant(a))
+		return const_names.names[~a];
+	return var_names.names[a];
+}
+
+void BlockTable::draw(Emitter &drawer, FuncTable &func, const vector<sym_t> &shown, const SymbolTable &callees, int indent)
+{
+	string white;
+	for (int i = 0; i < indent; ++i)
+		white.append(" ");
+	drawer << white << "<" << func.block_names.names[id] << ">\n";
+	drawer << white << "PRE:(";
+	for (auto i = pre.begin(); i != pre.end(); ++i)
+		drawer << func.block_names.names[*i] << ",";
+	drawer << ")\n";
+	drawer << white << "IN:( ";
+	for (auto i = shown.begin(); i != shown.end(); ++i)
+		if (*i < IN.size())
+			IN.get(*i).draw(drawer, func.var_names.names[*i]);
+	drawer << ")\n";
+	drawer << white << "statements:\n";
+	const Instr *s = func.code.data() + first;
+	for (int k = 0; k < count; ++k, ++s)
+	{
+		drawer << white << "    " << "(" << k + 1 << ")" << op_name[s->op] << " ";
+		switch (s->op)
+		{
+		case ADD:
+		case SUB:
+		case MUL:
+		case DIV:
+			drawer << func.spell(s->result) << "," << func.spell(s->arg1) << "," << func.spell(s->arg2) << '\n';
+			break;
+		case CALL:
+			drawer << func.spell(s->result) << "," << callees.names[s->arg1] << "(";
+			for (int j = 0; j < s->count; ++j)
+				drawer << func.spell(func.operands[s->first + j]) << ",";
+			drawer << ")\n";
+			break;
+		case ASSIGN:
+		case INT_CAST:
+		case FLOAT_CAST:
+			drawer << func.spell(s->result) << "," << func.spell(s->arg1) << '\n';
+			break;
+		case GOTO:
+		case RETURN:
+			drawer << func.spell(s->result) << '\n';
+			break;
+		default:
+			drawer << func.spell(s->arg1) << "," << func.spell(s->arg2) << '\n';
+			break;
+		}
+	}
+	drawer << white << "OUT:( ";
+	for (auto i = shown.begin(); i != shown.end(); ++i)
+		if (*i < OUT.size())
+			OUT.get(*i).draw(drawer, func.var_names.names[*i]);
+	drawer << ")\n";
+	drawer << white << "NEXT:(";
+	for (auto i = next.begin(); i != next.end(); ++i)
+		drawer << func.block_names.names[*i] << ",";
+	drawer << ")\n";
+	drawer << '\n';
+}
+
+void FuncTable::draw(Emitter &drawer, const SymbolTable &callees)
+{
+	if (!drawer.options.keeps_func(func_name))
+		return;
+	/* print in name order, ids only follow the order of appearance */
+	vector<sym_t> shown, order;
+	for (sym_t i = 0; i < vars.size(); ++i)
+		if (vars[i] != nullptr && drawer.options.keeps_var(var_names.names[i]))
+			shown.push_back(i);
+	sort(shown.begin(), shown.end(), [this](sym_t a, sym_t b) { return var_names.names[a] < var_names.names[b]; });
+	for (sym_t i = 0; i < blocks.size(); ++i)
+		if (blocks[i] != nullptr)
+			order.push_back(i);
+	sort(order.begin(), order.end(), [this](sym_t a, sym_t b) { return block_names.names[a] < block_names.names[b]; });
+	if (drawer.options.format != FMT_TEXT)
+	{
+		emit(drawer, shown, order);
+		return;
+	}
+	drawer << "**********************************\n";
+	drawer << "function: " << func_name << (approximate ? " (approximate)\n" : "\n");
+	drawer << "parameters: ( ";
+	for (int i = 0; i < args.size(); ++i)
+		if (drawer.options.keeps_var(var_names.names[args[i]]))
+			vars[args[i]]->draw(drawer, var_names.names[args[i]]);
+	drawer << ")\n";
+	drawer << "return: ( ";
+	if (ret != nullptr)
+		ret->draw(drawer, "return");
+	drawer << ")\n";
+	drawer << "variables: ( ";
+	for (auto i = shown.begin(); i != shown.end(); ++i)
+		vars[*i]->draw(drawer, var_names.names[*i]);
+	drawer << ")\n";
+	drawer << "----------------\n";
+	drawer << "blocks:\n";
+	for (auto i = order.begin(); i != order.end(); ++i)
+	{
+		blocks[*i]->draw(drawer, *this, shown, callees);
+	}
+	drawer << "\n\n";
+}
+
+/* the ranges of the function as one json line or one binary record */
+void FuncTable::emit(Emitter &e, const vector<sym_t> &shown, const vector<sym_t> &order)
+{
+	vector<sym_t> params;
+	for (int i = 0; i < args.size(); ++i)
+		if (e.options.keeps_var(var_names.names[args[i]]))
+			params.push_back(args[i]);
+	VarTable bottom;
+	if (e.options.format == FMT_BINARY)
+	{
+		e.name(func_name);
+		e.raw((uint32_t)params.size());
+		for (auto i = params.begin(); i != params.end(); ++i)
+		{
+			e.name(var_names.names[*i]);
+			vars[*i]->emit(e);
+		}
+		e.raw((uint8_t)(ret != nullptr));
+		(ret != nullptr ? *ret : bottom).emit(e);
+		e.raw((uint32_t)shown.size());
+		for (auto i = shown.begin(); i != shown.end(); ++i)
+		{
+			e.name(var_names.names[*i]);
+			vars[*i]->emit(e);
+		}
+		e.raw((uint32_t)order.size());
+		for (auto b = order.begin(); b != order.end(); ++b)
+		{
+			BlockTable *blk = blocks[*b];
+			e.name(block_names.names[*b]);
+			for (auto i = shown.begin(); i != shown.end(); ++i)
+				(*i < blk->IN.size() ? blk->IN.get(*i) : bottom).emit(e);
+			for (auto i = shown.begin(); i != shown.end(); ++i)
+				(*i < blk->OUT.size() ? blk->OUT.get(*i) : bottom).emit(e);
+		}
+		return;
+	}
+	e << "{\"function\": ";
+	json_string(e, func_name);
+	if (approximate)
+		e << ", \"approximate\": true";
+	e << ", \"parameters\": {";
+	for (auto i = params.begin(); i != params.end(); ++i)
+	{
+		e << (i == params.begin() ? "" : ", ");
+		json_string(e, var_names.names[*i]);
+		e << ": ";
+		vars[*i]->emit(e);
+	}
+	e << "}, \"return\": ";
+	if (ret != nullptr)
+		ret->emit(e);
+	else
+		e << "null";
+	e << ", \"variables\": {";
+	for (auto i = shown.begin(); i != shown.end(); ++i)
+	{
+		e << (i == shown.begin() ? "" : ", ");
+		json_string(e, var_names.names[*i]);
+		e << ": ";
+		vars[*i]->emit(e);
+	}
+	e << "}, \"blocks\": [";
+	for (auto b = order.begin(); b != order.end(); ++b)
+	{
+		BlockTable *blk = blocks[*b];
+		e << (b == order.begin() ? "{\"block\": " : ", {\"block\": ");
+		json_string(e, block_names.names[*b]);
+		for (int side = 0; side < 2; ++side)
+		{
+			const Env &env = side == 0 ? blk->IN : blk->OUT;
+			e << (side == 0 ? ", \"in\": {" : "}, \"out\": {");
+			bool first = true;
+			for (auto i = shown.begin(); i != shown.end(); ++i)
+				if (*i < env.size())
+				{
+					e << (first ? "" : ", ");
+					json_string(e, var_names.names[*i]);
+					e << ": ";
+					env.get(*i).emit(e);
+					first = false;
+				}
+		}
+		e << "}}";
+	}
+	e << "]}\n";
+}
+
+/* constants appear in operands as plain numbers, e.g. "3", "-1", "2.5e+0" */
+bool is_number(string_view a)
+{
+	if (a.empty())
+		return false;
+	size_t i = 0;
+	if (a[0] == '-' || a[0] == '+')
+		i = 1;
+	return i < a.size() && ((a[i] >= '0' && a[i] <= '9') || a[i] == '.');
+}
+
+void Stats::add(FuncTable *f)
+{
+	int blocks = 0, statements = 0, variables = 0;
+	for (auto b = f->blocks.begin(); b != f->blocks.end(); ++b)
+		if (*b != nullptr)
+		{
+			blocks++;
+			statements += (*b)->count;
+		}
+	for (auto v = f->vars.begin(); v != f->vars.end(); ++v)
+		variables += *v != nullptr;
+	ostringstream out;
+	out << "{\"name\": ";
+	json_string(out, f->func_name);
+	out << ", \"line\": " << f->line << ", \"blocks\": " << blocks << ", \"statements\": " << statements
+		<< ", \"variables\": " << variables << ", \"loops\": " << f->flow.loops << ", \"irreducible\": " << f->flow.irreducible << ", \"unreachable\": " << f->flow.unreachable
+		<< ", \"pops\": " << f->pops << ", \"widenings\": " << f->widenings
+		<< ", \"narrowings\": " << f->narrowings << ", \"approximate\": " << (f->approximate ? "true" : "false")
+		<< ", \"allocations\": " << f->arena.nodes
+		<< ", \"arena_bytes\": " << f->arena.allocated << ", \"visits\": {";
+	bool first = true;
+	for (sym_t b = 0; b < f->visits.size(); ++b)
+	{
+		if (f->visits[b] == 0)
+			continue;
+		out << (first ? "" : ", ");
+		json_string(out, f->block_names.names[b]);
+		out << ": " << f->visits[b];
+		first = false;
+	}
+	out << "}}";
+	functions.push_back(out.str());
+}
+
+/* nanoseconds of p, less the phases that ran inside it */
+long long Stats::own(PHASE p)
+{
+	long long inside = 0;
+	if (p == PH_PARSE)
+		inside += ns[PH_LEX] + ns[PH_WIRE];
+	if (streamed && p == outer)
+		inside += ns[PH_SOLVE] + ns[PH_DRAW];
+	return max(0LL, ns[p] - inside);
+}
+
+void Stats::write(ostream &out, const string &input)
+{
+	out << "{\"input\": ";
+	json_string(out, input);
+	out << ", \"phases_ms\": {";
+	for (int p = 0; p < PH_COUNT; ++p)
+		out << (p ? ", " : "") << '"' << phase_name[p] << "\": " << own((PHASE)p) / 1e6;
+	out << "}, \"functions\": [";
+	for (int i = 0; i < functions.size(); ++i)
+		out << (i ? ",\n  " : "\n  ") << functions[i];
+	out << "]}";
+}
+
+class GlobalTable;
+
+/* how functions are solved: block by block over dense states, or over a sparse SSA graph */
+enum ENGINE {EN_DENSE, EN_SPARSE};
+
+/*
+ * how long one solve of a function may run, 0 for no limit. past either
+ * limit the solver stops waiting for loops to settle: every loop header
+ * is widened straight to infinity and narrowing is skipped, so it ends
+ * soon after with ranges as sound as before, only wider, and the function
+ * is marked approximate
+ */
+class Budget
+{
+public:
+	long long iterations = 0;
+	long long ms = 0;
+	bool limited() const { return iterations > 0 || ms > 0; }
+	bool spent(long long done, chrono::steady_clock::time_point began) const;
+};
+
+bool Budget::spent(long long done, chrono::steady_clock::time_point began) const
+{
+	if (iterations > 0 && done >= iterations)
+		return true;
+	/* the clock is read every 64 iterations, reading it costs more than an iteration */
+	return ms > 0 && (done & 63) == 0 && chrono::steady_clock::now() - began >= chrono::milliseconds(ms);
+}
+
+/*
+ * what a CALL evaluates to. a callee whose scc is already solved is solved
+ * again for the argument ranges of the call, memoized per (callee, ranges)
+ * in a bounded table. callees of the caller's own scc, and callees already
+ * freed by streaming, answer with their context free summary. so do calls
+ * nested too deep, or past the solves one outermost call may spend. what
+ * was cut short that way is memoized only until the outermost call returns,
+ * and a shared answer is charged the solves it took, so answers do not
+ * depend on what other threads ran.
+ */
+class CallResolver
+{
+	GlobalTable &table;
+	mutex lock;
+	map<pair<sym_t, vector<double>>, pair<VarTable, int>> memo;	// to the answer and the solves it took
+	size_t limit;
+	static const int depth_limit = 32;	// of calls being solved inside one another
+	static const int solve_limit = 32;	// of solves under one outermost call
+public:
+	vector<char> settled;		// by function id, its scc is solved
+	CallResolver(GlobalTable &_table, size_t _limit = 4096) : table(_table), limit(_limit) {}
+	VarTable call(sym_t callee, const vector<VarTable> &args);
+};
+
+class RangeSolver
+{
+	FuncTable *func;
+	EnvPool &pool;
+	CallResolver *calls;		// nullptr leaves calls opaque
+	bool contextual;			// solved for one call, func is left as it was
+	const vector<BlockTable*> &order;	// of func->flow, blocks reachable from entry
+	const EdgeRows &succ;
+	const EdgeRows &pred;
+	const vector<bool> &header;			// loop headers, where we widen
+	const vector<double> &thresholds;
+	chrono::steady_clock::time_point began;
+	vector<bool> in_reach;
+	vector<bool> out_reach;
+	vector<bool> done;
+	vector<int> widens;
+	vector<int> narrows;
+	vector<int> visits;
+	vector<Env> in;		// by block index
+	vector<Env> out;
+	Env start;			// declared ranges, where the entry begins
+	Env scratch;
+	Env back;
+	VarTable ret;		// joined over the reachable returns
+	bool returned;
+	vector<VarTable> actuals;
+	static const int widen_delay = 2;
+	static const int threshold_steps = 2;	// widenings stopped at a threshold, the next go to infinity
+	static const int narrow_limit = 2;
+
+	void fixpoint();
+	void number();
+	void prepare();
+	void run(bool narrowing);
+	bool visit(int b, bool narrowing);
+	bool transfer(BlockTable *blk, Env &env, bool record);
+	bool refine(const Instr *s, Env &env);
+	void eval(sym_t a, Env &env, VarTable &res);
+	bool tracked(sym_t a);
+	void assign(sym_t a, Env &env, const VarTable &v);
+public:
+	int iterations;
+	Budget budget;
+	bool approximate = false;	// the budget ran out
+	int cut_at = 0;				// iterations when it did
+	RangeSolver(FuncTable *_func, CallResolver *_calls = nullptr)
+		: func(_func), pool(_func->envs), calls(_calls), contextual(false), order(_func->flow.order),
+		succ(_func->flow.succ), pred(_func->flow.pred), header(_func->flow.header),
+		thresholds(_func->flow.thresholds), returned(false), iterations(0) {}
+	RangeSolver(FuncTable *_func, EnvPool &_pool, CallResolver *_calls)
+		: func(_func), pool(_pool), calls(_calls), contextual(true), order(_func->flow.order),
+		succ(_func->flow.succ), pred(_func->flow.pred), header(_func->flow.header),
+		thresholds(_func->flow.thresholds), returned(false), iterations(0) {}
+	void solve();
+	VarTable solve(const vector<VarTable> &args);
+};
+
+/* false when there is no entry, the graph is left empty then */
+bool FlowGraph::build(FuncTable *func)
+{
+	/* iterative dfs over next, postorder reversed gives rpo */
+	vector<BlockTable*> post;
+	vector<bool> seen(func->blocks.size(), false);
+	stack<pair<BlockTable*, size_t>> work;
+	order.clear();
+	index.assign(func->blocks.size(), -1);
+	succ.clear();
+	pred.clear();
+	idom.clear();
+	loop.clear();
+	depth.clear();
+	header.clear();
+	loops = irreducible = unreachable = 0;
+	gather(func);
+	if (func->entry == NO_SYM || func->blocks[func->entry] == nullptr)
+		return false;
+	/* edges out of a closed block are never taken, what only they reach is left out */
+	vector<bool> closed;
+	propagate(func, closed);
+	work.push(make_pair(func->blocks[func->entry], 0));
+	seen[func->entry] = true;
+	while (!work.empty())
+	{
+		BlockTable *blk = work.top().first;
+		size_t k = work.top().second;
+		if (k < blk->next.size() && !closed[blk->id])
+		{
+			work.top().second++;
+			sym_t to = blk->next[k];
+			if (func->blocks[to] == nullptr || seen[to])
+				continue;
+			seen[to] = true;
+			work.push(make_pair(func->blocks[to], 0));
+			continue;
+		}
+		post.push_back(blk);
+		work.pop();
+	}
+	for (auto b = func->blocks.begin(); b != func->blocks.end(); ++b)
+		unreachable += *b != nullptr && !seen[(*b)->id];
+	/* index holds places in rpo until the loops are laid out */
+	vector<BlockTable*> rpo(post.rbegin(), post.rend());
+	int n = rpo.size();
+	for (int i = 0; i < n; ++i)
+		index[rpo[i]->id] = i;
+	vector<pair<int, int>> edges;
+	for (int i = 0; i < n; ++i)
+		for (auto j = rpo[i]->next.begin(); j != rpo[i]->next.end(); ++j)
+			if (index[*j] >= 0)
+				edges.push_back(make_pair(i, index[*j]));
+	EdgeRows to, from;
+	to.fill(n, edges, false);
+	from.fill(n, edges, true);
+
+	/* dominators as Cooper, Harvey and Kennedy find them, over rpo indices */
+	vector<int> dom(n, -1);
+	dom[0] = 0;
+	for (bool changed = true; changed; )
+	{
+		changed = false;
+		for (int b = 1; b < n; ++b)
+		{
+			int d = -1;
+			for (auto p = from[b].begin(); p != from[b].end(); ++p)
+			{
+				if (dom[*p] < 0)
+					continue;
+				if (d < 0)
+				{
+					d = *p;
+					continue;
+				}
+				int x = *p;
+				while (x != d)
+				{
+					while (x > d)
+						x = dom[x];
+					while (d > x)
+						d = dom[d];
+				}
+			}
+			if (dom[b] != d)
+			{
+				dom[b] = d;
+				changed = true;
+			}
+		}
+	}
+
+	/* natural loops, inner headers first as they come later in rpo. a block
+	 * keeps the first loop that claims it, an inner header the first that
+	 * holds it as its parent */
+	vector<int> in_loop(n, -1), parent(n, -1), mark(n, -1);
+	vector<bool> head(n, false);
+	vector<int> walk;
+	for (int h = n - 1; h >= 0; --h)
+	{
+		walk.clear();
+		for (auto p = from[h].begin(); p != from[h].end(); ++p)
+		{
+			if (*p < h)
+				continue;
+			head[h] = true;
+			int d = *p;
+			while (d != h && d != 0)
+				d = dom[d];
+			if (d == h)
+				walk.push_back(*p);
+			else
+				irreducible++;	/* still widened at h, so the cycle is cut */
+		}
+		if (walk.empty())
+			continue;
+		loops++;
+		in_loop[h] = h;
+		mark[h] = h;
+		while (!walk.empty())
+		{
+			int b = walk.back();
+			walk.pop_back();
+			if (mark[b] == h)
+				continue;
+			mark[b] = h;
+			if (in_loop[b] < 0)
+				in_loop[b] = h;
+			else if (in_loop[b] == b && parent[b] < 0)
+				parent[b] = h;
+			for (auto p = from[b].begin(); p != from[b].end(); ++p)
+				if (mark[*p] != h)
+					walk.push_back(*p);
+		}
+	}
+
+	/* lay each loop out after its header, members in rpo. a loop's members
+	 * are the blocks it holds directly and the headers of loops it holds */
+	vector<vector<int>> members(n + 1);
+	for (int b = 0; b < n; ++b)
+	{
+		int l = in_loop[b] == b ? parent[b] : in_loop[b];
+		members[l < 0 ? n : l].push_back(b);
+	}
+	vector<int> at(n);
+	vector<pair<int, size_t>> nest;
+	order.reserve(n);
+	nest.push_back(make_pair(n, 0));
+	while (!nest.empty())
+	{
+		auto &top = nest.back();
+		if (top.second == members[top.first].size())
+		{
+			nest.pop_back();
+			continue;
+		}
+		int b = members[top.first][top.second++];
+		at[b] = order.size();
+		index[rpo[b]->id] = at[b];
+		order.push_back(rpo[b]);
+		if (in_loop[b] == b)
+			nest.push_back(make_pair(b, 0));
+	}
+
+	/* everything else renumbered to match */
+	for (auto e = edges.begin(); e != edges.end(); ++e)
+		*e = make_pair(at[e->first], at[e->second]);
+	succ.fill(n, edges, false);
+	pred.fill(n, edges, true);
+	idom.assign(n, 0);
+	loop.assign(n, -1);
+	depth.assign(n, 0);
+	header.assign(n, false);
+	for (int b = 0; b < n; ++b)
+	{
+		int i = at[b];
+		idom[i] = at[dom[b]];
+		header[i] = header[i] || head[b];
+		for (auto t = succ[i].begin(); t != succ[i].end(); ++t)
+			if (*t <= i)
+				header[*t] = true;	/* any cycle left in an irreducible part */
+		if (in_loop[b] >= 0)
+			loop[i] = at[in_loop[b]];
+		for (int l = in_loop[b]; l >= 0; l = parent[l])
+			depth[i]++;
+	}
+	return true;
+}
+
+void RangeSolver::number()
+{
+	if (order.empty() && !contextual)
+		func->errors.push_back(myError(ANALYSIS_ERROR, string("function ") + func->func_name + " has no blocks", func->line));
+}
+
+void RangeSolver::prepare()
+{
+	/* environments are sized at solve time, so late declarations are covered */
+	sym_t n_vars = func->vars.size();
+	pool.proto.clear();
+	for (sym_t i = 0; i < n_vars; ++i)
+	{
+		pool.proto.push_back(func->vars[i] ? *func->vars[i] : VarTable(i, FLOAT));
+		pool.proto.back().set_empty();
+	}
+	Env bottom(&pool, n_vars);
+	start = bottom;
+	for (sym_t i = 0; i < n_vars; ++i)
+		if (func->vars[i] != nullptr)
+			start.mut(i).copy_range(*func->vars[i]);
+	scratch = bottom;
+	back = bottom;
+	int n = order.size();
+	in.assign(n, bottom);
+	out.assign(n, bottom);
+	in_reach.assign(n, false);
+	out_reach.assign(n, false);
+	done.assign(n, false);
+	widens.assign(n, 0);
+	narrows.assign(n, 0);
+	visits.assign(n, 0);
+	began = chrono::steady_clock::now();
+}
+
+bool RangeSolver::tracked(sym_t a)
+{
+	/* only declared variables are tracked */
+	return a >= 0 && func->vars[a] != nullptr;
+}
+
+void RangeSolver::assign(sym_t a, Env &env, const VarTable &v)
+{
+	/* writes are skipped when nothing changes, to keep nodes shared */
+	if (!tracked(a) || env.get(a).same(v))
+		return;
+	env.mut(a).copy_range(v);
+}
+
+void RangeSolver::eval(sym_t a, Env &env, VarTable &res)
+{
+	if (is_constant(a))
+	{
+		res.type = func->consts[~a].type;
+		res.copy_range(func->consts[~a]);
+		return;
+	}
+	if (!tracked(a))
+	{
+		/* unknown names, e.g. globals, may hold anything */
+		res.type = FLOAT;
+		res.set_full();
+		return;
+	}
+	const VarTable &v = env.get(a);
+	res.type = v.type;
+	res.copy_range(v);
+}
+
+double mul_end(double x, double y)
+{
+	/* 0 * inf is 0 for interval ends */
+	if (x == 0 || y == 0)
+		return 0;
+	return x * y;
+}
+
+/*
+ * the arithmetic of statements, typed at compile time. an Interval<INT>
+ * has closed int64 ends that saturate, the extremes standing for the
+ * infinities, so integer ends are added, multiplied and divided exactly
+ * at any size. an Interval<FLOAT> has double ends, each open or closed,
+ * rounded outward: an end is computed to nearest and moved a step out
+ * only when an error free transformation shows the rounding went inward,
+ * so the rounding mode is never changed and exact ends stay as they are.
+ * this is a layer over the storage, not the storage: VarTable keeps its
+ * double ends, a statement converts its operands into the interval type it
+ * computes in and converts the result back.
+ */
+template <DATA_TYPE T> class Interval;
+
+template <> class Interval<INT>
+{
+public:
+	int64_t lo = INT64_MAX;
+	int64_t hi = INT64_MIN;
+	bool empty() const { return lo > hi; }
+	static Interval of(const VarTable &v);
+	void put(VarTable &v) const;
+};
+
+template <> class Interval<FLOAT>
+{
+public:
+	double lo = INFINITY;
+	double hi = -INFINITY;
+	bool open[2] = { false, false };
+	bool empty() const { return lo > hi || (lo == hi && (open[0] || open[1])); }
+	static Interval of(const VarTable &v);
+	void put(VarTable &v) const;
+};
+
+inline bool is_inf(int64_t x)
+{
+	return x == INT64_MIN || x == INT64_MAX;
+}
+
+/* a finite end past int64 on the side of pos, kept finite when that is the inner side */
+inline int64_t overflow_end(bool pos, bool up)
+{
+	if (pos)
+		return up ? INT64_MAX : INT64_MAX - 1;
+	return up ? INT64_MIN + 1 : INT64_MIN;
+}
+
+/* a whole double to int64 as the end on the side of up */
+int64_t to_int64(double x, bool up)
+{
+	if (std::isinf(x))
+		return x > 0 ? INT64_MAX : INT64_MIN;
+	if (x <= -9223372036854775808.0)
+		return overflow_end(false, up);
+	if (x >= 9223372036854775808.0)
+		return overflow_end(true, up);
+	return (int64_t)x;
+}
+
+/* an int64 to the double on the side of up, ends past 2^53 are not exact */
+double to_double(int64_t x, bool up)
+{
+	if (is_inf(x))
+		return x > 0 ? INFINITY : -INFINITY;
+	/* d is whole, and past int64 only when rounded up to 2^63 */
+	double d = (double)x;
+	bool above = d >= 0x1p63 || (int64_t)d > x, below = d < 0x1p63 && (int64_t)d < x;
+	if (up ? below : above)
+		d = nextafter(d, up ? INFINITY : -INFINITY);
+	return d;
+}
+
+Interval<INT> Interval<INT>::of(const VarTable &v)
+{
+	Interval r;
+	if (v.empty())
+		return r;
+	double l = ceil(v.low), u = floor(v.up);
+	if (l == v.low && v.bound[0] == '(')
+		l += 1;
+	if (u == v.up && v.bound[1] == ')')
+		u -= 1;
+	r.lo = to_int64(l, false);
+	r.hi = to_int64(u, true);
+	return r;
+}
+
+void Interval<INT>::put(VarTable &v) const
+{
+	if (empty())
+		v.set_empty();
+	else
+		v.set(to_double(lo, false), to_double(hi, true));
+}
+
+Interval<FLOAT> Interval<FLOAT>::of(const VarTable &v)
+{
+	Interval r;
+	if (v.empty())
+		return r;
+	r.lo = v.low;
+	r.hi = v.up;
+	r.open[0] = v.bound[0] == '(';
+	r.open[1] = v.bound[1] == ')';
+	return r;
+}
+
+void Interval<FLOAT>::put(VarTable &v) const
+{
+	if (empty())
+		v.set_empty();
+	else
+		v.set(lo, hi, open[0] ? '(' : '[', open[1] ? ')' : ']');
+}
+
+/* the whole numbers in x */
+Interval<INT> to_int(const Interval<FLOAT> &x)
+{
+	Interval<INT> r;
+	if (x.empty())
+		return r;
+	double l = ceil(x.lo), u = floor(x.hi);
+	if (l == x.lo && x.open[0])
+		l += 1;
+	if (u == x.hi && x.open[1])
+		u -= 1;
+	r.lo = to_int64(l, false);
+	r.hi = to_int64(u, true);
+	return r;
+}
+
+Interval<FLOAT> to_float(const Interval<INT> &x)
+{
+	Interval<FLOAT> r;
+	if (x.empty())
+		return r;
+	r.lo = to_double(x.lo, false);
+	r.hi = to_double(x.hi, true);
+	return r;
+}
+
+/* the ends of what lo to hi truncates to, an open whole end is not reached */
+inline void trunc_ends(double &lo, double &hi, bool open_lo, bool open_hi)
+{
+	double l = trunc(lo), u = trunc(hi);
+	/* only ends away from zero move, (-3, truncates to -2 but (3, to 3 */
+	if (open_lo && l == lo && l < 0)
+		l += 1;
+	if (open_hi && u == hi && u > 0)
+		u -= 1;
+	lo = l;
+	hi = u;
+}
+
+/* what x gives cast to int, truncated toward zero */
+Interval<INT> truncate(const Interval<FLOAT> &x)
+{
+	Interval<INT> r;
+	if (x.empty())
+		return r;
+	double l = x.lo, u = x.hi;
+	trunc_ends(l, u, x.open[0], x.open[1]);
+	r.lo = to_int64(l, false);
+	r.hi = to_int64(u, true);
+	return r;
+}
+
+/* x + y saturated as the end on the side of up, where infinities of opposite sign meet */
+int64_t add_end(int64_t x, int64_t y, bool up)
+{
+	if (is_inf(x) && is_inf(y) && x != y)
+		return up ? INT64_MAX : INT64_MIN;
+	if (is_inf(x))
+		return x;
+	if (is_inf(y))
+		return y;
+	int64_t r;
+	if (__builtin_add_overflow(x, y, &r))
+		return overflow_end(x > 0, up);
+	return r;
+}
+
+inline int64_t neg_end(int64_t x)
+{
+	return x == INT64_MIN ? INT64_MAX : x == INT64_MAX ? INT64_MIN : -x;
+}
+
+/* x * y saturated as add_end, 0 * inf is 0 as mul_end takes it */
+int64_t mul_end(int64_t x, int64_t y, bool up)
+{
+	if (x == 0 || y == 0)
+		return 0;
+	int64_t r;
+	if (is_inf(x) || is_inf(y))
+		return (x < 0) == (y < 0) ? INT64_MAX : INT64_MIN;
+	if (__builtin_mul_overflow(x, y, &r))
+		return overflow_end((x < 0) == (y < 0), up);
+	return r;
+}
+
+/* the rounding error of s = x + y, exactly (two sum) */
+inline double sum_error(double x, double y, double s)
+{
+	double bb = s - x;
+	return (x - (s - bb)) + (y - bb);
+}
+
+/* below this the error of a product or quotient may itself underflow */
+const double TINY = DBL_MIN * 0x1p54;
+
+/* a result r of finite operands that overflowed, or that may have lost its
+ * error to underflow, moved a step out on the side of up */
+inline double step_out(double r, bool up)
+{
+	if (std::isinf(r))
+		return up == (r > 0) ? r : (r > 0 ? DBL_MAX : -DBL_MAX);
+	return nextafter(r, up ? INFINITY : -INFINITY);
+}
+
+/* x + y rounded toward +inf when up, else toward -inf */
+double add_end(double x, double y, bool up)
+{
+	double s = x + y;
+	if (std::isnan(s))
+		return up ? INFINITY : -INFINITY;
+	if (std::isinf(x) || std::isinf(y))
+		return s;
+	if (std::isinf(s))
+		return step_out(s, up);
+	double e = sum_error(x, y, s);
+	return (up ? e > 0 : e < 0) ? nextafter(s, up ? INFINITY : -INFINITY) : s;
+}
+
+/* x * y as mul_end, rounded as add_end */
+double mul_end(double x, double y, bool up)
+{
+	if (x == 0 || y == 0)
+		return 0;
+	double p = x * y;
+	if (std::isinf(x) || std::isinf(y))
+		return p;
+	if (std::isinf(p) || fabs(p) < TINY)
+		return step_out(p, up);
+	double e = fma(x, y, -p);
+	return (up ? e > 0 : e < 0) ? nextafter(p, up ? INFINITY : -INFINITY) : p;
+}
+
+/* x / y rounded as add_end, y is not 0 unless signed to say where 0 is approached from */
+double div_end(double x, double y, bool up)
+{
+	double q = x / y;
+	if (std::isnan(q) || std::isinf(x) || std::isinf(y) || y == 0)
+		return q;
+	if (std::isinf(q) || fabs(q) < TINY)
+		return x == 0 ? q : step_out(q, up);
+	/* x = q * y + r exactly, the true quotient is past q on the side r / y points to */
+	double r = fma(-q, y, x);
+	bool above = r != 0 && (r > 0) == (y > 0);
+	bool below = r != 0 && (r > 0) != (y > 0);
+	return (up ? above : below) ? nextafter(q, up ? INFINITY : -INFINITY) : q;
+}
+
+void range_add(const Interval<INT> &a, const Interval<INT> &b, Interval<INT> &res)
+{
+	res.lo = add_end(a.lo, b.lo, false);
+	res.hi = add_end(a.hi, b.hi, true);
+}
+
+void range_add(const Interval<FLOAT> &a, const Interval<FLOAT> &b, Interval<FLOAT> &res)
+{
+	res.lo = add_end(a.lo, b.lo, false);
+	res.hi = add_end(a.hi, b.hi, true);
+	res.open[0] = a.open[0] || b.open[0];
+	res.open[1] = a.open[1] || b.open[1];
+}
+
+void range_sub(const Interval<INT> &a, const Interval<INT> &b, Interval<INT> &res)
+{
+	res.lo = add_end(a.lo, neg_end(b.hi), false);
+	res.hi = add_end(a.hi, neg_end(b.lo), true);
+}
+
+void range_sub(const Interval<FLOAT> &a, const Interval<FLOAT> &b, Interval<FLOAT> &res)
+{
+	res.lo = add_end(a.lo, -b.hi, false);
+	res.hi = add_end(a.hi, -b.lo, true);
+	res.open[0] = a.open[0] || b.open[1];
+	res.open[1] = a.open[1] || b.open[0];
+}
+
+void range_mul(const Interval<INT> &a, const Interval<INT> &b, Interval<INT> &res)
+{
+	int64_t xs[2] = { a.lo, a.hi }, ys[2] = { b.lo, b.hi };
+	res.lo = INT64_MAX;
+	res.hi = INT64_MIN;
+	for (int i = 0; i < 2; ++i)
+		for (int j = 0; j < 2; ++j)
+		{
+			res.lo = min(res.lo, mul_end(xs[i], ys[j], false));
+			res.hi = max(res.hi, mul_end(xs[i], ys[j], true));
+		}
+}
+
+void range_mul(const Interval<FLOAT> &a, const Interval<FLOAT> &b, Interval<FLOAT> &res)
+{
+	double xs[2] = { a.lo, a.hi }, ys[2] = { b.lo, b.hi };
+	res.lo = INFINITY;
+	res.hi = -INFINITY;
+	for (int i = 0; i < 2; ++i)
+		for (int j = 0; j < 2; ++j)
+		{
+			res.lo = min(res.lo, mul_end(xs[i], ys[j], false));
+			res.hi = max(res.hi, mul_end(xs[i], ys[j], true));
+		}
+	res.open[0] = res.open[1] = false;
+}
+
+void range_div(const Interval<INT> &a, const Interval<INT> &b, Interval<INT> &res)
+{
+	if (b.lo <= 0 && b.hi >= 0)
+	{
+		if (b.lo == 0 && b.hi == 0)
+		{
+			res.lo = INT64_MIN;
+			res.hi = INT64_MAX;
+			return;
+		}
+		/* integer division skips 0, split the divisor around it */
+		Interval<INT> neg, pos, part;
+		neg.lo = b.lo;
+		neg.hi = -1;
+		pos.lo = 1;
+		pos.hi = b.hi;
+		res = Interval<INT>();
+		for (const Interval<INT> *y : { &neg, &pos })
+		{
+			if (y->empty())
+				continue;
+			range_div(a, *y, part);
+			res.lo = min(res.lo, part.lo);
+			res.hi = max(res.hi, part.hi);
+		}
+		return;
+	}
+	/* truncation toward zero is monotone, the ends come from the corners */
+	int64_t xs[2] = { a.lo, a.hi }, ys[2] = { b.lo, b.hi };
+	res.lo = INT64_MAX;
+	res.hi = INT64_MIN;
+	for (int i = 0; i < 2; ++i)
+		for (int j = 0; j < 2; ++j)
+		{
+			int64_t x = xs[i], y = ys[j], q;
+			if (is_inf(y))
+			{
+				/* inf / inf may end anywhere between 0 and inf */
+				if (is_inf(x))
+					q = (x > 0) == (y > 0) ? INT64_MAX : INT64_MIN;
+				else
+					q = 0;
+				res.lo = min(res.lo, (int64_t)0);
+				res.hi = max(res.hi, (int64_t)0);
+			}
+			else if (is_inf(x))
+				q = (x > 0) == (y > 0) ? INT64_MAX : INT64_MIN;
+			else
+				q = x / y;
+			res.lo = min(res.lo, q);
+			res.hi = max(res.hi, q);
+		}
+}
+
+/* split takes the divisor as whole numbers, which skip 0; whole truncates the quotient */
+void range_div(const Interval<FLOAT> &a, const Interval<FLOAT> &b, Interval<FLOAT> &res, bool split, bool whole)
+{
+	bool has_zero = (b.lo < 0 || (b.lo == 0 && !b.open[0])) && (b.hi > 0 || (b.hi == 0 && !b.open[1]));
+	res.open[0] = res.open[1] = false;
+	if (has_zero)
+	{
+		if (split && (b.lo < 0 || b.hi > 0))
+		{
+			Interval<FLOAT> neg, pos, part;
+			neg.lo = b.lo;
+			neg.hi = -1;
+			pos.lo = 1;
+			pos.hi = b.hi;
+			res.lo = INFINITY;
+			res.hi = -INFINITY;
+			for (const Interval<FLOAT> *y : { &neg, &pos })
+			{
+				if (y->empty())
+					continue;
+				range_div(a, *y, part, split, whole);
+				res.lo = min(res.lo, part.lo);
+				res.hi = max(res.hi, part.hi);
+			}
+			return;
+		}
+		res.lo = -INFINITY;
+		res.hi = INFINITY;
+		return;
+	}
+	/* an end at 0 is approached from inside the divisor */
+	double yl = (b.lo == 0) ? 0.0 : b.lo, yu = (b.hi == 0) ? -0.0 : b.hi;
+	double xs[2] = { a.lo, a.hi }, ys[2] = { yl, yu };
+	double lo = INFINITY, hi = -INFINITY;
+	for (int i = 0; i < 2; ++i)
+		for (int j = 0; j < 2; ++j)
+		{
+			if (std::isinf(xs[i]) && std::isinf(ys[j]))
+			{
+				/* inf / inf may end anywhere between 0 and inf */
+				double q = ((xs[i] > 0) == (ys[j] > 0)) ? INFINITY : -INFINITY;
+				lo = min(lo, min(q, 0.0));
+				hi = max(hi, max(q, 0.0));
+				continue;
+			}
+			double down = div_end(xs[i], ys[j], false), up = div_end(xs[i], ys[j], true);
+			if (std::isnan(down))
+				continue;
+			lo = min(lo, down);
+			hi = max(hi, up);
+		}
+	if (whole)
+	{
+		/* integer division truncates toward zero, which is monotone */
+		lo = trunc(lo);
+		hi = trunc(hi);
+	}
+	res.lo = lo;
+	res.hi = hi;
+}
+
+/*
+ * a binary statement with a result of type R and operands of types A and
+ * B. integer operands compute in Interval<INT>, as C does, so an integer
+ * quotient is truncated even when it is stored to a float; a float operand
+ * computes in Interval<FLOAT>. put then converts to the type of the result,
+ * VarTable::set fitting an integer result to whole numbers
+ */
+template <DATA_TYPE R, DATA_TYPE A, DATA_TYPE B>
+void range_arith(OP_TYPE op, const VarTable &a, const VarTable &b, VarTable &res)
+{
+	typedef Interval<A == INT && B == INT ? INT : FLOAT> Range;
+	Range x = Range::of(a), y = Range::of(b), z;
+	if (x.empty() || y.empty())
+	{
+		res.set_empty();
+		return;
+	}
+	if (op == ADD)
+		range_add(x, y, z);
+	else if (op == SUB)
+		range_sub(x, y, z);
+	else if (op == MUL)
+		range_mul(x, y, z);
+	else if constexpr (A == INT && B == INT)
+		range_div(x, y, z);
+	else
+		range_div(x, y, z, B == INT && R == INT, R == INT);
+	z.put(res);
+}
+
+/* a cast or assign to type R of an operand of type A */
+template <DATA_TYPE R, DATA_TYPE A>
+void range_cast(OP_TYPE op, const VarTable &a, VarTable &res)
+{
+	Interval<A> x = Interval<A>::of(a);
+	Interval<R> z;
+	if constexpr (A == FLOAT)
+	{
+		if (op == INT_CAST)
+		{
+			/* truncated whatever the result is stored as */
+			if constexpr (R == INT)
+				z = truncate(x);
+			else
+				z = to_float(truncate(x));
+			z.put(res);
+			return;
+		}
+	}
+	if constexpr (R == A)
+		z = x;
+	else if constexpr (R == INT)
+		z = to_int(x);
+	else
+		z = to_float(x);
+	z.put(res);
+}
+
+typedef void (*ArithFn)(OP_TYPE op, const VarTable &a, const VarTable &b, VarTable &res);
+typedef void (*CastFn)(OP_TYPE op, const VarTable &a, VarTable &res);
+
+/* by the types of the result and the operands */
+const ArithFn arith_fns[2][2][2] = {
+	{ { range_arith<INT, INT, INT>, range_arith<INT, INT, FLOAT> }, { range_arith<INT, FLOAT, INT>, range_arith<INT, FLOAT, FLOAT> } },
+	{ { range_arith<FLOAT, INT, INT>, range_arith<FLOAT, INT, FLOAT> }, { range_arith<FLOAT, FLOAT, INT>, range_arith<FLOAT, FLOAT, FLOAT> } }
+};
+const CastFn cast_fns[2][2] = {
+	{ range_cast<INT, INT>, range_cast<INT, FLOAT> },
+	{ range_cast<FLOAT, INT>, range_cast<FLOAT, FLOAT> }
+};
+
+/* what an arithmetic, cast or assign statement gives, into res as typed; b is read by binary ops only */
+void range_apply(OP_TYPE op, const VarTable &a, const VarTable &b, VarTable &res)
+{
+	if (op == ADD || op == SUB || op == MUL || op == DIV)
+		arith_fns[res.type][a.type][b.type](op, a, b, res);
+	else
+		cast_fns[res.type][a.type](op, a, res);
+}
+
+/* narrows a and b to what guard op lets through, false if nothing does */
+bool refine_guard(OP_TYPE op, VarTable &a, VarTable &b);
+
+/*
+ * the widening thresholds: the constants statements compute with, and
+ * around each constant a guard compares against the values just inside
+ * and outside it for integers, so a loop counter stops where its guard does
+ */
+void FlowGraph::gather(FuncTable *func)
+{
+	thresholds.clear();
+	for (auto s = func->code.begin(); s != func->code.end(); ++s)
+	{
+		if (s->op == CALL || s->op == GOTO || s->op == RETURN)
+			continue;
+		bool guard = s->op >= GOTO_EQ && s->op <= GOTO_G;
+		sym_t ops[2] = { s->arg1, s->arg2 };
+		for (int k = 0; k < 2; ++k)
+		{
+			if (!is_constant(ops[k]))
+				continue;
+			const VarTable &c = func->consts[~ops[k]];
+			if (c.empty() || std::isinf(c.low) || std::isinf(c.up))
+				continue;
+			thresholds.push_back(c.low);
+			thresholds.push_back(c.up);
+			if (guard && c.type == INT)
+			{
+				thresholds.push_back(c.low - 1);
+				thresholds.push_back(c.up + 1);
+			}
+		}
+	}
+	sort(thresholds.begin(), thresholds.end());
+	thresholds.erase(unique(thresholds.begin(), thresholds.end()), thresholds.end());
+}
+
+/*
+ * conditional constant propagation ahead of building the graph. a variable
+ * is known at a point while every path taken to it leaves the same single
+ * value there; values are folded with range_apply and guards tested with
+ * refine_guard, as the solvers do. a block is closed when one of its guards
+ * can not hold for the known values, its edges are then never taken. only
+ * taken edges carry values, so a loop only forgets a constant once its back
+ * edge is taken. parameters and calls are never known, so what is closed
+ * holds for any call
+ */
+void FlowGraph::propagate(FuncTable *func, vector<bool> &closed)
+{
+	typedef vector<pair<sym_t, VarTable>> Known;	// by var
+	size_t n_blocks = func->blocks.size();
+	sym_t n_vars = func->vars.size();
+	vector<Known> at(n_blocks);
+	vector<bool> reached(n_blocks, false), queued(n_blocks, false);
+	vector<VarTable> cur(n_vars);
+	vector<char> known(n_vars, 0);
+	vector<sym_t> touched, work;
+	Known out;
+	closed.assign(n_blocks, false);
+	auto value = [&](sym_t a, VarTable &res)
+	{
+		if (is_constant(a))
+		{
+			res.type = func->consts[~a].type;
+			res.copy_range(func->consts[~a]);
+		}
+		else if (a >= 0 && func->vars[a] != nullptr)
+		{
+			res.type = func->vars[a]->type;
+			if (known[a])
+				res.copy_range(cur[a]);
+			else
+				res.set_full();
+		}
+		else
+		{
+			res.type = FLOAT;
+			res.set_full();
+		}
+	};
+	auto put = [&](sym_t a, const VarTable &v)
+	{
+		if (a < 0 || func->vars[a] == nullptr)
+			return;
+		bool point = v.low == v.up && isfinite(v.low) && v.bound[0] == '[' && v.bound[1] == ']';
+		if (point)
+			cur[a] = v;
+		if (point && !known[a])
+			touched.push_back(a);
+		known[a] = point;
+	};
+	reached[func->entry] = queued[func->entry] = true;
+	work.push_back(func->entry);
+	VarTable a(NO_SYM, INT), b(NO_SYM, INT);
+	while (!work.empty())
+	{
+		sym_t id = work.back();
+		work.pop_back();
+		queued[id] = false;
+		BlockTable *blk = func->blocks[id];
+		touched.clear();
+		for (auto k = at[id].begin(); k != at[id].end(); ++k)
+		{
+			cur[k->first] = k->second;
+			known[k->first] = 1;
+			touched.push_back(k->first);
+		}
+		bool holds = true;
+		const Instr *s = func->code.data() + blk->first;
+		for (const Instr *end = s + blk->count; s != end && holds; ++s)
+		{
+			if (s->op == CALL)
+				put(s->result, VarTable());
+			else if (s->op >= GOTO_EQ && s->op <= GOTO_G)
+			{
+				value(s->arg1, a);
+				value(s->arg2, b);
+				holds = refine_guard(s->op, a, b);
+				if (holds)
+				{
+					put(s->arg1, a);
+					put(s->arg2, b);
+				}
+			}
+			else if (s->op != GOTO && s->op != RETURN && s->result >= 0 && func->vars[s->result] != nullptr)
+			{
+				VarTable res(NO_SYM, func->vars[s->result]->type);
+				value(s->arg1, a);
+				if (s->op == ADD || s->op == SUB || s->op == MUL || s->op == DIV)
+					value(s->arg2, b);
+				range_apply(s->op, a, b, res);
+				put(s->result, res);
+			}
+		}
+		out.clear();
+		for (auto t = touched.begin(); t != touched.end(); ++t)
+			if (known[*t])
+			{
+				out.push_back(make_pair(*t, cur[*t]));
+				known[*t] = 0;
+			}
+		sort(out.begin(), out.end(), [](const pair<sym_t, VarTable> &x, const pair<sym_t, VarTable> &y) { return x.first < y.first; });
+		/* a guard only stops holding with more known, which never comes back */
+		closed[id] = !holds;
+		if (!holds)
+			continue;
+		for (auto t = blk->next.begin(); t != blk->next.end(); ++t)
+		{
+			if (func->blocks[*t] == nullptr)
+				continue;
+			Known &in = at[*t];
+			size_t before = in.size();
+			if (!reached[*t])
+			{
+				reached[*t] = true;
+				in = out;
+			}
+			else
+			{
+				/* keep what the edge agrees on, both are sorted by var */
+				size_t w = 0, j = 0;
+				for (size_t i = 0; i < in.size(); ++i)
+				{
+					while (j < out.size() && out[j].first < in[i].first)
+						j++;
+					if (j < out.size() && out[j].first == in[i].first && out[j].second.same(in[i].second))
+						in[w++] = in[i];
+				}
+				in.resize(w);
+				if (w == before)
+					continue;
+			}
+			if (!queued[*t])
+			{
+				queued[*t] = true;
+				work.push_back(*t);
+			}
+		}
+	}
+}
+
+bool refine_guard(OP_TYPE op, VarTable &a, VarTable &b)
+{
+	if (a.empty() || b.empty())
+		return false;
+	VarTable cx(a), cy(b);	// what the guard allows for each side
+	switch (op)
+	{
+	case GOTO_L:
+		cx.set(-INFINITY, b.up, '[', ')');
+		cy.set(a.low, INFINITY, '(', ']');
+		break;
+	case GOTO_LE:
+		cx.set(-INFINITY, b.up, '[', b.bound[1]);
+		cy.set(a.low, INFINITY, a.bound[0], ']');
+		break;
+	case GOTO_G:
+		cx.set(b.low, INFINITY, '(', ']');
+		cy.set(-INFINITY, a.up, '[', ')');
+		break;
+	case GOTO_GE:
+		cx.set(b.low, INFINITY, b.bound[0], ']');
+		cy.set(-INFINITY, a.up, '[', a.bound[1]);
+		break;
+	case GOTO_EQ:
+		cx.copy_range(b);
+		cy.copy_range(a);
+		break;
+	case GOTO_NE:
+		cx.set_full();
+		cy.set_full();
+		/* only a single excluded value at an end can be cut off */
+		if (b.low == b.up)
+		{
+			if (a.low == b.low)
+				cx.set(a.low, INFINITY, '(', ']');
+			else if (a.up == b.low)
+				cx.set(-INFINITY, a.up, '[', ')');
+		}
+		if (a.low == a.up)
+		{
+			if (b.low == a.low)
+				cy.set(b.low, INFINITY, '(', ']');
+			else if (b.up == a.low)
+				cy.set(-INFINITY, b.up, '[', ')');
+		}
+		break;
+	default:
+		return true;
+	}
+	a.meet(cx);
+	b.meet(cy);
+	return !a.empty() && !b.empty();
+}
+
+bool RangeSolver::refine(const Instr *s, Env &env)
+{
+	VarTable a(NO_SYM, INT), b(NO_SYM, INT);
+	eval(s->arg1, env, a);
+	eval(s->arg2, env, b);
+	if (!refine_guard(s->op, a, b))
+		return false;
+	assign(s->arg1, env, a);
+	assign(s->arg2, env, b);
+	return true;
+}
+
+bool RangeSolver::transfer(BlockTable *blk, Env &env, bool record)
+{
+	/* apply statements of blk to env, false if a guard can not hold */
+	VarTable a(NO_SYM, INT), b(NO_SYM, INT);
+	const Instr *s = func->code.data() + blk->first;
+	for (const Instr *end = s + blk->count; s != end; ++s)
+	{
+		if (s->op == CALL)
+		{
+			VarTable res(NO_SYM, FLOAT);
+			if (calls != nullptr)
+			{
+				actuals.resize(s->count);
+				for (int k = 0; k < s->count; ++k)
+					eval(func->operands[s->first + k], env, actuals[k]);
+				res = calls->call(s->arg1, actuals);
+			}
+			if (tracked(s->result))
+			{
+				res.type = func->vars[s->result]->type;
+				res.fit();
+			}
+			assign(s->result, env, res);
+			continue;
+		}
+		if (s->op >= GOTO_EQ && s->op <= GOTO_G)
+		{
+			if (!refine(s, env))
+				return false;
+			continue;
+		}
+		if (s->op == GOTO)
+			continue;
+		if (s->op == RETURN)
+		{
+			if (!record || s->result == NO_SYM)
+				continue;
+			VarTable v(NO_SYM, INT);
+			eval(s->result, env, v);
+			if (!returned)
+			{
+				ret = v;
+				ret.set_empty();
+				returned = true;
+			}
+			ret.join(v);
+			continue;
+		}
+		if (!tracked(s->result))
+			continue;
+		VarTable res(NO_SYM, func->vars[s->result]->type);
+		eval(s->arg1, env, a);
+		if (s->op == ADD || s->op == SUB || s->op == MUL || s->op == DIV)
+			eval(s->arg2, env, b);
+		range_apply(s->op, a, b, res);
+		assign(s->result, env, res);
+	}
+	return true;
+}
+
+bool RangeSolver::visit(int b, bool narrowing)
+{
+	/* returns whether OUT of block b changed */
+	BlockTable *blk = order[b];
+	bool reach = false, looped = false;
+	scratch.clear();
+	back.clear();
+	if (b == 0)
+	{
+		scratch = start;
+		reach = true;
+	}
+	for (auto p = pred[b].begin(); p != pred[b].end(); ++p)
+	{
+		if (!out_reach[*p])
+			continue;
+		/* values coming around a loop are kept apart from those entering it */
+		if (*p >= b)
+		{
+			back.join(out[*p]);
+			looped = true;
+		}
+		else
+			scratch.join(out[*p]);
+		reach = true;
+	}
+	if (!reach)
+		return false;
+	iterations++;
+	visits[b]++;
+	TRACE(TR_ITER, EV_ITERATION, 0, func->func_name, b, narrowing);
+	if (!approximate && budget.limited() && budget.spent(iterations, began))
+	{
+		approximate = true;
+		cut_at = iterations;
+	}
+	if (!in_reach[b])
+	{
+		scratch.join(back);
+		in[b] = scratch;
+	}
+	else if (header[b] && narrowing)
+	{
+		scratch.join(back);
+		if (narrows[b] >= narrow_limit || scratch.same(in[b]))
+		{
+			if (done[b])
+				return false;
+		}
+		else
+		{
+			narrows[b]++;
+			in[b].narrow(scratch, &thresholds);
+		}
+	}
+	else if (header[b] && looped && (++widens[b] > widen_delay || approximate))
+	{
+		/* only growth around the loop is widened, growth from outside is
+		 * bounded by the widening of the enclosing loop */
+		Env w = in[b];
+		w.widen(back, approximate || widens[b] > widen_delay + threshold_steps ? nullptr : &thresholds);
+		scratch.join(w);
+		if (scratch.same(in[b]) && done[b])
+			return false;
+		in[b] = scratch;
+	}
+	else
+	{
+		scratch.join(back);
+		if (header[b] && !narrowing)
+			scratch.join(in[b]);
+		if (scratch.same(in[b]) && done[b])
+			return false;
+		in[b] = scratch;
+	}
+	in_reach[b] = true;
+	done[b] = true;
+	scratch = in[b];
+	if (!transfer(blk, scratch, false))
+	{
+		if (!out_reach[b])
+			return false;
+		out_reach[b] = false;
+		out[b].clear();
+		return true;
+	}
+	if (out_reach[b] && scratch.same(out[b]))
+		return false;
+	out_reach[b] = true;
+	out[b] = scratch;
+	return true;
+}
+
+void RangeSolver::run(bool narrowing)
+{
+	/* always pick the earliest block, so an inner loop settles before its outer one goes on */
+	priority_queue<int, vector<int>, greater<int>> work;
+	vector<bool> queued(order.size(), false);
+	if (narrowing)
+	{
+		for (int i = 0; i < order.size(); ++i)
+		{
+			work.push(i);
+			queued[i] = true;
+		}
+	}
+	else
+	{
+		work.push(0);
+		queued[0] = true;
+	}
+	/* what narrowing did so far is sound, it stops once the budget runs out */
+	while (!work.empty() && !(narrowing && approximate))
+	{
+		int b = work.top();
+		work.pop();
+		queued[b] = false;
+		if (!visit(b, narrowing))
+			continue;
+		for (auto s = succ[b].begin(); s != succ[b].end(); ++s)
+		{
+			if (queued[*s])
+				continue;
+			queued[*s] = true;
+			work.push(*s);
+		}
+	}
+}
+
+void RangeSolver::fixpoint()
+{
+	run(false);
+	fill(done.begin(), done.end(), false);
+	run(true);
+	/* returned ranges are read off the final states */
+	for (int b = 0; b < order.size(); ++b)
+	{
+		if (!in_reach[b])
+			continue;
+		scratch = in[b];
+		transfer(order[b], scratch, true);
+	}
+	TRACE(TR_FUNC, EV_SOLVED, 0, func->func_name, iterations, order.size());
+}
+
+void RangeSolver::solve()
+{
+	number();
+	prepare();
+	if (!order.empty())
+		fixpoint();
+	/* the states are kept on the blocks, unreached ones stay bottom */
+	Env bottom(&pool, func->vars.size());
+	for (auto b = func->blocks.begin(); b != func->blocks.end(); ++b)
+	{
+		if (*b == nullptr)
+			continue;
+		(*b)->IN = bottom;
+		(*b)->OUT = bottom;
+	}
+	for (int b = 0; b < order.size(); ++b)
+	{
+		order[b]->IN = in[b];
+		order[b]->OUT = out[b];
+	}
+	func->pops += iterations;
+	if (approximate)
+		func->ran_out(cut_at);
+	func->visits.resize(func->blocks.size(), 0);
+	for (int b = 0; b < order.size(); ++b)
+	{
+		func->visits[order[b]->id] += visits[b];
+		func->widenings += max(0, widens[b] - widen_delay);
+		func->narrowings += narrows[b];
+	}
+	if (!returned)
+		func->ret = nullptr;
+	else if (func->ret == nullptr)
+		func->ret = func->arena.make<VarTable>(ret);
+	else
+		*func->ret = ret;
+}
+
+VarTable RangeSolver::solve(const vector<VarTable> &args)
+{
+	/* the parameters start from the ranges passed in, nothing of func changes */
+	number();
+	prepare();
+	for (int i = 0; i < args.size() && i < func->args.size(); ++i)
+	{
+		VarTable v = args[i];
+		v.type = func->vars[func->args[i]]->type;
+		v.fit();
+		start.mut(func->args[i]).copy_range(v);
+	}
+	if (!order.empty())
+		fixpoint();
+	return returned ? ret : VarTable();
+}
+
+/*
+ * the sparse engine. the statements are put in SSA form as a graph of
+ * nodes, one per definition: the ranges variables start from, statements,
+ * sigmas where a guard narrows its operands, and phis where values of a
+ * variable meet. phis are placed only where a variable is read, the way
+ * Braun et al. build SSA without dominators. the graph is solved an scc at
+ * a time in dependence order; an scc without a cycle is evaluated once,
+ * a cycle is iterated with its phis widened and then narrowed. so the
+ * cost follows the definitions rather than blocks times variables. blocks
+ * past a guard that can not hold are dropped and the graph solved again
+ * without them, until no more are dropped. block states are filled in from
+ * the nodes afterwards, for drawing.
+ */
+enum NODE_KIND {ND_ENTRY, ND_DEF, ND_SIGMA, ND_PHI};
+
+class SparseNode
+{
+public:
+	NODE_KIND kind;
+	bool second = false;	// a sigma narrowing the second operand of its guard
+	sym_t var;
+	int block;				// block index
+	int instr = -1;			// in FuncTable::code, of a def or sigma
+	int first = 0;			// operands, a range of SparseSolver::inputs
+	int count = 0;
+	VarTable val;
+	SparseNode(NODE_KIND _kind, sym_t _var, int _block) : kind(_kind), var(_var), block(_block) {}
+};
+
+class SparseSolver
+{
+	FuncTable *func;
+	CallResolver *calls;
+	bool contextual;
+	const vector<BlockTable*> &order;	// of func->flow
+	const EdgeRows &succ;
+	const EdgeRows &pred;
+	const vector<bool> &header;
+	const vector<double> &thresholds;
+	chrono::steady_clock::time_point began;
+	vector<SparseNode> nodes;
+	vector<int> inputs;				// >= 0 a node, else a constant or NO_SYM for unknown
+	vector<unordered_map<sym_t, int>> entry;	// by block index, var to the node it enters with
+	vector<unordered_map<sym_t, int>> last;		// by block index, var to its last node defined there
+	vector<int> starts;				// by var, its node at the entry, -1 until read
+	vector<int> pending;			// phis whose operands are still to be read
+	vector<pair<int, int>> returns;	// block and operand of each return
+	vector<pair<int, int>> guards;	// block and statement of each guard, its operands follow in guard_inputs
+	vector<int> guard_inputs;
+	vector<bool> live_in;			// by block index, reached along guards that can hold
+	vector<bool> live_out;
+	vector<int> widens;				// by node
+	vector<int> narrows;
+	vector<char> settled;			// by node, its value is final
+	vector<int> index;				// by node, for the tarjan walk of demand
+	vector<int> low;
+	vector<char> on;
+	vector<int> stack_nodes;
+	vector<int> scc;
+	vector<pair<int, int>> walk;
+	vector<int> visits;				// by block index
+	vector<VarTable> actuals;
+	vector<VarTable> args;			// of a contextual solve
+	VarTable ret;					// joined over the reachable returns
+	bool returned = false;
+	static const int widen_delay = 2;
+	static const int threshold_steps = 2;	// widenings stopped at a threshold, the next go to infinity
+	static const int narrow_limit = 2;
+
+	bool tracked(sym_t a)
+	{
+		return a >= 0 && func->vars[a] != nullptr;
+	}
+	int add(NODE_KIND kind, sym_t var, int block);
+	int operand(sym_t a, int b);
+	int read(sym_t v, int b);
+	int read_entry(sym_t v, int b);
+	bool feeds(const SparseNode &node, int k);
+	bool prune();
+	void place_phis();
+	void build();
+	VarTable value(int in);
+	VarTable eval(int n);
+	void demand(int root);
+	void solve_from(int first);
+	void forget();
+	VarTable grow(int n);
+	void settle(const vector<int> &cycle);
+	void fill_blocks();
+public:
+	int iterations = 0;
+	int widenings = 0;
+	int narrowings = 0;
+	Budget budget;
+	bool approximate = false;	// the budget ran out
+	int cut_at = 0;				// iterations when it did
+	SparseSolver(FuncTable *_func, CallResolver *_calls = nullptr, bool _contextual = false)
+		: func(_func), calls(_calls), contextual(_contextual), order(_func->flow.order),
+		succ(_func->flow.succ), pred(_func->flow.pred), header(_func->flow.header),
+		thresholds(_func->flow.thresholds) {}
+	void solve();
+	VarTable solve(const vector<VarTable> &_args);
+	void open();
+	VarTable query(sym_t block, sym_t var);
+};
+
+int SparseSolver::add(NODE_KIND kind, sym_t var, int block)
+{
+	nodes.push_back(SparseNode(kind, var, block));
+	nodes.back().val = VarTable(var, tracked(var) ? func->vars[var]->type : FLOAT);
+	nodes.back().val.set_empty();
+	return nodes.size() - 1;
+}
+
+/* what statement operand a is read as in block b */
+int SparseSolver::operand(sym_t a, int b)
+{
+	if (is_constant(a))
+		return a;
+	if (!tracked(a))
+		return NO_SYM;
+	return read(a, b);
+}
+
+/* the node of v at the end of block b as filled so far */
+int SparseSolver::read(sym_t v, int b)
+{
+	auto found = last[b].find(v);
+	if (found != last[b].end())
+		return found->second;
+	return read_entry(v, b);
+}
+
+int SparseSolver::read_entry(sym_t v, int b)
+{
+	/* up a chain of single predecessors, which always come earlier in the order,
+	 * to a block where v is defined or a phi is needed */
+	vector<int> chain;
+	int n;
+	for (;;)
+	{
+		auto found = entry[b].find(v);
+		if (found != entry[b].end())
+		{
+			n = found->second;
+			break;
+		}
+		chain.push_back(b);
+		if (b != 0 && pred[b].size() == 1)
+		{
+			b = pred[b][0];
+			auto def = last[b].find(v);
+			if (def != last[b].end())
+			{
+				n = def->second;
+				break;
+			}
+			continue;
+		}
+		if (b == 0 && pred[b].empty())
+		{
+			if (starts[v] < 0)
+				starts[v] = add(ND_ENTRY, v, 0);
+			n = starts[v];
+			break;
+		}
+		/* operands are read once every block is filled */
+		n = add(ND_PHI, v, b);
+		pending.push_back(n);
+		break;
+	}
+	for (auto c = chain.begin(); c != chain.end(); ++c)
+		entry[*c][v] = n;
+	return n;
+}
+
+void SparseSolver::place_phis()
+{
+	/* reading operands may ask for further phis, which queue up behind */
+	vector<int> got;
+	while (!pending.empty())
+	{
+		int n = pending.back();
+		pending.pop_back();
+		sym_t v = nodes[n].var;
+		int b = nodes[n].block;
+		got.clear();
+		if (b == 0)
+		{
+			if (starts[v] < 0)
+				starts[v] = add(ND_ENTRY, v, 0);
+			got.push_back(starts[v]);
+		}
+		for (auto p = pred[b].begin(); p != pred[b].end(); ++p)
+			got.push_back(read(v, *p));
+		nodes[n].first = inputs.size();
+		nodes[n].count = got.size();
+		inputs.insert(inputs.end(), got.begin(), got.end());
+	}
+}
+
+void SparseSolver::build()
+{
+	int blocks = order.size();
+	entry.assign(blocks, unordered_map<sym_t, int>());
+	last.assign(blocks, unordered_map<sym_t, int>());
+	starts.assign(func->vars.size(), -1);
+	for (int b = 0; b < blocks; ++b)
+	{
+		BlockTable *blk = order[b];
+		for (int i = blk->first; i < blk->first + blk->count; ++i)
+		{
+			const Instr &s = func->code[i];
+			if (s.op == GOTO)
+				continue;
+			if (s.op == RETURN)
+			{
+				if (s.result != NO_SYM)
+					returns.push_back(make_pair(b, operand(s.result, b)));
+				continue;
+			}
+			if (s.op >= GOTO_EQ && s.op <= GOTO_G)
+			{
+				/* both sigmas read the operands as they were before the guard */
+				int x = operand(s.arg1, b), y = operand(s.arg2, b);
+				guards.push_back(make_pair(b, i));
+				guard_inputs.push_back(x);
+				guard_inputs.push_back(y);
+				for (int side = 0; side < 2; ++side)
+				{
+					sym_t v = side ? s.arg2 : s.arg1;
+					if (!tracked(v) || (side && v == s.arg1))
+						continue;
+					int n = add(ND_SIGMA, v, b);
+					nodes[n].instr = i;
+					nodes[n].second = side;
+					nodes[n].first = inputs.size();
+					nodes[n].count = 2;
+					inputs.push_back(x);
+					inputs.push_back(y);
+					last[b][v] = n;
+				}
+				continue;
+			}
+			if (!tracked(s.result))
+				continue;
+			int first = inputs.size();
+			if (s.op == CALL)
+			{
+				for (int k = 0; k < s.count; ++k)
+					inputs.push_back(operand(func->operands[s.first + k], b));
+			}
+			else
+			{
+				inputs.push_back(operand(s.arg1, b));
+				if (s.op == ADD || s.op == SUB || s.op == MUL || s.op == DIV)
+					inputs.push_back(operand(s.arg2, b));
+			}
+			int n = add(ND_DEF, s.result, b);
+			nodes[n].instr = i;
+			nodes[n].first = first;
+			nodes[n].count = inputs.size() - first;
+			last[b][s.result] = n;
+		}
+	}
+	place_phis();
+}
+
+VarTable SparseSolver::value(int in)
+{
+	if (in >= 0)
+		return nodes[in].val;
+	if (is_constant(in))
+		return func->consts[~in];
+	/* unknown names, e.g. globals, may hold anything */
+	return VarTable(NO_SYM, FLOAT);
+}
+
+VarTable SparseSolver::eval(int n)
+{
+	SparseNode &node = nodes[n];
+	VarTable res(node.var, func->vars[node.var]->type);
+	const int *in = inputs.data() + node.first;
+	if (node.kind == ND_ENTRY)
+	{
+		res.copy_range(*func->vars[node.var]);
+		for (int i = 0; i < args.size() && i < func->args.size(); ++i)
+			if (func->args[i] == node.var)
+				res.copy_range(args[i]);
+		res.fit();
+		return res;
+	}
+	if (node.kind == ND_PHI)
+	{
+		res.set_empty();
+		for (int k = 0; k < node.count; ++k)
+			if (feeds(node, k))
+				res.join(nodes[in[k]].val);
+		return res;
+	}
+	const Instr &s = func->code[node.instr];
+	if (node.kind == ND_SIGMA)
+	{
+		VarTable a = value(in[0]), b = value(in[1]);
+		if (!refine_guard(s.op, a, b))
+			res.set_empty();
+		else
+			res.copy_range(node.second ? b : a);
+		return res;
+	}
+	if (s.op == CALL)
+	{
+		VarTable got(NO_SYM, FLOAT);
+		if (calls != nullptr)
+		{
+			actuals.resize(node.count);
+			for (int k = 0; k < node.count; ++k)
+				actuals[k] = value(in[k]);
+			got = calls->call(s.arg1, actuals);
+		}
+		res.copy_range(got);
+		res.fit();
+		return res;
+	}
+	range_apply(s.op, value(in[0]), node.count > 1 ? value(in[1]) : VarTable(), res);
+	return res;
+}
+
+/*
+ * solves root and what it reads that is not settled yet: an iterative
+ * tarjan over operand edges, an scc comes out after those it reads
+ */
+void SparseSolver::demand(int root)
+{
+	int n = nodes.size(), counter = 0;
+	settled.resize(n, 0);
+	index.resize(n, -1);
+	low.resize(n, 0);
+	on.resize(n, 0);
+	widens.resize(n, 0);
+	narrows.resize(n, 0);
+	if (settled[root])
+		return;
+	index[root] = low[root] = counter++;
+	stack_nodes.push_back(root);
+	on[root] = 1;
+	walk.push_back(make_pair(root, 0));
+	while (!walk.empty())
+	{
+		int v = walk.back().first;
+		if (walk.back().second < nodes[v].count)
+		{
+			int w = inputs[nodes[v].first + walk.back().second++];
+			if (w < 0 || settled[w])
+				continue;
+			if (index[w] < 0)
+			{
+				index[w] = low[w] = counter++;
+				stack_nodes.push_back(w);
+				on[w] = 1;
+				walk.push_back(make_pair(w, 0));
+			}
+			else if (on[w])
+				low[v] = min(low[v], index[w]);
+			continue;
+		}
+		walk.pop_back();
+		if (!walk.empty())
+			low[walk.back().first] = min(low[walk.back().first], low[v]);
+		if (low[v] != index[v])
+			continue;
+		scc.clear();
+		int w;
+		do
+		{
+			w = stack_nodes.back();
+			stack_nodes.pop_back();
+			on[w] = 0;
+			scc.push_back(w);
+		} while (w != v);
+		bool cyclic = scc.size() > 1;
+		for (int k = 0; !cyclic && k < nodes[v].count; ++k)
+			cyclic = inputs[nodes[v].first + k] == v;
+		if (!cyclic)
+		{
+			iterations++;
+			visits[nodes[v].block]++;
+			if (!approximate && budget.limited() && budget.spent(iterations, began))
+			{
+				approximate = true;
+				cut_at = iterations;
+			}
+			nodes[v].val = eval(v);
+		}
+		else
+			settle(scc);
+		for (auto m = scc.begin(); m != scc.end(); ++m)
+			settled[*m] = 1;
+	}
+}
+
+void SparseSolver::solve_from(int first)
+{
+	for (int root = first; root < nodes.size(); ++root)
+		demand(root);
+}
+
+/* every value back to bottom, to be solved again */
+void SparseSolver::forget()
+{
+	for (auto n = nodes.begin(); n != nodes.end(); ++n)
+		n->val.set_empty();
+	fill(widens.begin(), widens.end(), 0);
+	fill(narrows.begin(), narrows.end(), 0);
+	fill(settled.begin(), settled.end(), 0);
+	fill(index.begin(), index.end(), -1);
+}
+
+/* a phi at a loop header while its cycle is iterated, widened as RangeSolver::visit widens */
+VarTable SparseSolver::grow(int n)
+{
+	SparseNode &node = nodes[n];
+	const int *in = inputs.data() + node.first;
+	VarTable ahead = node.val, back = node.val;
+	back.set_empty();
+	bool looped = false;
+	for (int k = 0; k < node.count; ++k)
+	{
+		if (!feeds(node, k))
+			continue;
+		/* the entry phi takes the starting range first, then one per predecessor */
+		int p = node.block == 0 ? k - 1 : k;
+		if (p >= 0 && pred[node.block][p] >= node.block)
+		{
+			back.join(nodes[in[k]].val);
+			looped = true;
+		}
+		else
+			ahead.join(nodes[in[k]].val);
+	}
+	if (looped && (++widens[n] > widen_delay || approximate))
+	{
+		/* only growth around the loop is widened, growth from outside is
+		 * bounded by the widening of the enclosing loop */
+		VarTable w = node.val;
+		w.widen(back, approximate || widens[n] > widen_delay + threshold_steps ? nullptr : &thresholds);
+		if (!w.same(node.val))
+			widenings++;
+		ahead.join(w);
+	}
+	else
+		ahead.join(back);
+	return ahead;
+}
+
+void SparseSolver::settle(const vector<int> &cycle)
+{
+	/* earlier nodes first, so inner loops settle before what they feed */
+	vector<int> scc(cycle);
+	sort(scc.begin(), scc.end());
+	unordered_map<int, vector<int>> within;		// node to its users in scc
+	for (auto m = scc.begin(); m != scc.end(); ++m)
+		for (int k = 0; k < nodes[*m].count; ++k)
+		{
+			int from = inputs[nodes[*m].first + k];
+			if (from >= 0 && binary_search(scc.begin(), scc.end(), from))
+				within[from].push_back(*m);
+		}
+	for (int narrowing = 0; narrowing < 2; ++narrowing)
+	{
+		priority_queue<int, vector<int>, greater<int>> queue;
+		unordered_set<int> queued(scc.begin(), scc.end());
+		for (auto m = scc.begin(); m != scc.end(); ++m)
+			queue.push(*m);
+		/* as RangeSolver::run, narrowing stops once the budget runs out */
+		while (!queue.empty() && !(narrowing && approximate))
+		{
+			int m = queue.top();
+			queue.pop();
+			queued.erase(m);
+			iterations++;
+			visits[nodes[m].block]++;
+			if (!approximate && budget.limited() && budget.spent(iterations, began))
+			{
+				approximate = true;
+				cut_at = iterations;
+			}
+			bool phi = nodes[m].kind == ND_PHI;
+			VarTable now = (phi && !narrowing) ? grow(m) : eval(m);
+			if (phi && narrowing)
+			{
+				/* only the ends lost to widening are taken back */
+				if (narrows[m] >= narrow_limit)
+					continue;
+				VarTable w = nodes[m].val;
+				w.narrow(now, &thresholds);
+				now = w;
+			}
+			if (now.same(nodes[m].val))
+				continue;
+			if (phi && narrowing)
+			{
+				narrows[m]++;
+				narrowings++;
+			}
+			nodes[m].val = now;
+			auto u = within.find(m);
+			if (u == within.end())
+				continue;
+			for (auto i = u->second.begin(); i != u->second.end(); ++i)
+				if (queued.insert(*i).second)
+					queue.push(*i);
+		}
+	}
+}
+
+/* whether operand k of a phi comes along an edge that can be taken */
+bool SparseSolver::feeds(const SparseNode &node, int k)
+{
+	if (node.block == 0 && k == 0)
+		return true;
+	return live_out[pred[node.block][node.block == 0 ? k - 1 : k]];
+}
+
+/*
+ * blocks reached only past a guard that can not hold are dropped, as the
+ * dense engine drops them. true when that drops more than the last round
+ * assumed, the graph is then solved again without them
+ */
+bool SparseSolver::prune()
+{
+	int blocks = order.size();
+	vector<bool> holds(blocks, true);
+	for (int g = 0; g < guards.size(); ++g)
+	{
+		VarTable a = value(guard_inputs[2 * g]), b = value(guard_inputs[2 * g + 1]);
+		if (!refine_guard(func->code[guards[g].second].op, a, b))
+			holds[guards[g].first] = false;
+	}
+	vector<bool> in(blocks, false), out(blocks, false);
+	vector<int> work;
+	if (blocks > 0)
+	{
+		in[0] = true;
+		work.push_back(0);
+	}
+	while (!work.empty())
+	{
+		int b = work.back();
+		work.pop_back();
+		out[b] = holds[b];
+		if (!out[b])
+			continue;
+		for (auto t = succ[b].begin(); t != succ[b].end(); ++t)
+			if (!in[*t])
+			{
+				in[*t] = true;
+				work.push_back(*t);
+			}
+	}
+	if (in == live_in && out == live_out)
+		return false;
+	live_in = in;
+	live_out = out;
+	return true;
+}
+
+void SparseSolver::fill_blocks()
+{
+	/* the dense view drawn for each block, read off the nodes */
+	sym_t n_vars = func->vars.size();
+	EnvPool &pool = func->envs;
+	pool.proto.clear();
+	for (sym_t i = 0; i < n_vars; ++i)
+	{
+		pool.proto.push_back(func->vars[i] ? *func->vars[i] : VarTable(i, FLOAT));
+		pool.proto.back().set_empty();
+	}
+	Env bottom(&pool, n_vars);
+	for (auto b = func->blocks.begin(); b != func->blocks.end(); ++b)
+	{
+		if (*b == nullptr)
+			continue;
+		(*b)->IN = bottom;
+		(*b)->OUT = bottom;
+	}
+	/* a block with one predecessor enters with what that one left */
+	int blocks = order.size(), before = nodes.size();
+	vector<vector<int>> in(blocks);
+	for (int b = 0; b < blocks; ++b)
+		if (live_in[b] && (b == 0 || pred[b].size() != 1))
+			for (sym_t v = 0; v < n_vars; ++v)
+				if (tracked(v))
+					in[b].push_back(read_entry(v, b));
+	place_phis();
+	solve_from(before);
+	for (int b = 0; b < blocks; ++b)
+	{
+		if (!live_in[b])
+			continue;
+		if (b != 0 && pred[b].size() == 1)
+			order[b]->IN = order[pred[b][0]]->OUT;
+		else
+			for (sym_t v = 0, k = 0; v < n_vars; ++v)
+			{
+				if (!tracked(v))
+					continue;
+				const VarTable &x = nodes[in[b][k++]].val;
+				if (!x.empty())
+					order[b]->IN.mut(v).copy_range(x);
+			}
+		if (!live_out[b])
+			continue;
+		order[b]->OUT = order[b]->IN;
+		for (auto d = last[b].begin(); d != last[b].end(); ++d)
+			order[b]->OUT.mut(d->first).copy_range(nodes[d->second].val);
+	}
+}
+
+void SparseSolver::solve()
+{
+	if (order.empty() && !contextual)
+		func->errors.push_back(myError(ANALYSIS_ERROR, string("function ") + func->func_name + " has no blocks", func->line));
+	began = chrono::steady_clock::now();
+	open();
+	/* each round can only drop blocks, so this ends. once the budget ran
+	 * out the blocks of the last round are kept, what they hold is sound */
+	for (solve_from(0); !approximate && prune(); solve_from(0))
+		forget();
+	returned = false;
+	for (auto r = returns.begin(); r != returns.end(); ++r)
+	{
+		if (!live_out[r->first])
+			continue;
+		VarTable v = value(r->second);
+		if (!returned)
+		{
+			ret = v;
+			ret.set_empty();
+			returned = true;
+		}
+		ret.join(v);
+	}
+	if (contextual)
+		return;
+	fill_blocks();
+	func->pops += iterations;
+	if (approximate)
+		func->ran_out(cut_at);
+	func->widenings += widenings;
+	func->narrowings += narrowings;
+	func->visits.resize(func->blocks.size(), 0);
+	for (int b = 0; b < order.size(); ++b)
+		func->visits[order[b]->id] += visits[b];
+	if (!returned)
+		func->ret = nullptr;
+	else if (func->ret == nullptr)
+		func->ret = func->arena.make<VarTable>(ret);
+	else
+		*func->ret = ret;
+}
+
+VarTable SparseSolver::solve(const vector<VarTable> &_args)
+{
+	/* the parameters start from the ranges passed in, nothing of func changes */
+	contextual = true;
+	args = _args;
+	for (int i = 0; i < args.size() && i < func->args.size(); ++i)
+	{
+		args[i].type = func->vars[func->args[i]]->type;
+		args[i].fit();
+	}
+	solve();
+	return returned ? ret : VarTable();
+}
+
+/* builds the graph with every block taken as live, nothing is solved until asked */
+void SparseSolver::open()
+{
+	visits.assign(order.size(), 0);
+	live_in.assign(order.size(), true);
+	live_out.assign(order.size(), true);
+	build();
+}
+
+/*
+ * the range var holds where block begins, after open. only the nodes it
+ * reads are solved, and they stay solved for the queries after. a block
+ * left out of the flow graph holds nothing
+ */
+VarTable SparseSolver::query(sym_t block, sym_t var)
+{
+	VarTable res(var, tracked(var) ? func->vars[var]->type : FLOAT);
+	int b = block >= 0 && block < func->flow.index.size() ? func->flow.index[block] : -1;
+	if (b < 0)
+		res.set_empty();
+	else if (tracked(var))
+	{
+		int n = read_entry(var, b);
+		place_phis();
+		demand(n);
+		res.copy_range(nodes[n].val);
+	}
+	return res;
+}
+
+/* solves f in place with the engine and budget given, the iterations it took */
+int solve_with(ENGINE engine, FuncTable *f, CallResolver *calls, const Budget &budget)
+{
+	if (engine == EN_SPARSE)
+	{
+		SparseSolver solver(f, calls);
+		solver.budget = budget;
+		solver.solve();
+		return solver.iterations;
+	}
+	RangeSolver solver(f, calls);
+	solver.budget = budget;
+	solver.solve();
+	return solver.iterations;
+}
+
+/*
+ * multi scenario solving: one fixpoint carries many sets of parameter
+ * ranges, each in a lane. a state keeps, per variable, the low ends, the
+ * up ends and the open flags of all lanes side by side, so the arithmetic
+ * of a statement runs over every lane at once, in SIMD where the target
+ * has it. each lane keeps its own worklist marks and widening and
+ * narrowing counts, so it ends where solving its scenario alone would.
+ * as with Env, states share their chunks of ENV_WIDTH variables until
+ * one is written, and merges skip the chunks two states still share.
+ */
+class LaneChunk
+{
+public:
+	/* by var % ENV_WIDTH * lanes + lane, an empty range is always (inf, -inf) and closed */
+	vector<double> lo;
+	vector<double> hi;
+	vector<uint8_t> open;	// 1 the low end is open, 2 the up end
+	LaneChunk(int n) : lo(ENV_WIDTH * n, INFINITY), hi(ENV_WIDTH * n, -INFINITY), open(ENV_WIDTH * n, 0) {}
+	bool empty(size_t k) const
+	{
+		return lo[k] > hi[k] || (lo[k] == hi[k] && open[k] != 0);
+	}
+	bool operator==(const LaneChunk &o) const
+	{
+		return lo == o.lo && hi == o.hi && open == o.open;
+	}
+};
+
+class Lanes
+{
+	shared_ptr<const LaneChunk> bottom;
+	const LaneChunk& read(size_t c) const
+	{
+		return chunks[c] ? *chunks[c] : *bottom;
+	}
+	bool full(const uint8_t *mask) const
+	{
+		return find(mask, mask + n, 0) == mask + n;
+	}
+public:
+	int n = 0;				// lanes
+	vector<shared_ptr<LaneChunk>> chunks;	// by var / ENV_WIDTH, null while all bottom
+	void reset(sym_t vars, int lanes)
+	{
+		n = lanes;
+		bottom = make_shared<const LaneChunk>(lanes);
+		chunks.assign((vars + ENV_MASK) / ENV_WIDTH, nullptr);
+	}
+	/* var v of lane l is at slot(v) + l of chunk v / ENV_WIDTH */
+	size_t slot(sym_t v) const
+	{
+		return (size_t)(v & ENV_MASK) * n;
+	}
+	const LaneChunk& of(sym_t v) const
+	{
+		return read(v >> ENV_SHIFT);
+	}
+	LaneChunk& mut(size_t c);
+	VarTable get(sym_t v, int l, DATA_TYPE type) const;
+	void put(sym_t v, int l, const VarTable &x);
+	void copy(const Lanes &o, const uint8_t *mask);
+	void clear(const uint8_t *mask);
+	void join(const Lanes &o, const uint8_t *mask);
+	void widen(const Lanes &o, const uint8_t *mask, const vector<DATA_TYPE> &types, const vector<double> &steps);
+	void narrow(const Lanes &o, const uint8_t *mask, const vector<DATA_TYPE> &types, const vector<double> &steps);
+	bool same(const Lanes &o, int l) const;
+};
+
+/* closes and rounds the ends of one lane as VarTable::fit does */
+inline void fit_lane(double &lo, double &hi, uint8_t &open, DATA_TYPE type)
+{
+	if (std::isinf(lo))
+		open &= ~1;
+	if (std::isinf(hi))
+		open &= ~2;
+	if (type == INT)
+	{
+		if (!std::isinf(lo))
+		{
+			double c = ceil(lo);
+			if (c == lo && (open & 1))
+				c += 1;
+			lo = c;
+			open &= ~1;
+		}
+		if (!std::isinf(hi))
+		{
+			double f = floor(hi);
+			if (f == hi && (open & 2))
+				f -= 1;
+			hi = f;
+			open &= ~2;
+		}
+	}
+	if (lo > hi || (lo == hi && open != 0))
+	{
+		lo = INFINITY;
+		hi = -INFINITY;
+		open = 0;
+	}
+}
+
+LaneChunk& Lanes::mut(size_t c)
+{
+	/* a chunk still shared is copied before it is written */
+	if (!chunks[c])
+		chunks[c] = make_shared<LaneChunk>(n);
+	else if (chunks[c].use_count() > 1)
+		chunks[c] = make_shared<LaneChunk>(*chunks[c]);
+	return *chunks[c];
+}
+
+VarTable Lanes::get(sym_t v, int l, DATA_TYPE type) const
+{
+	const LaneChunk &x = of(v);
+	size_t k = slot(v) + l;
+	return VarTable(v, type, x.lo[k], x.hi[k], (x.open[k] & 1) ? '(' : '[', (x.open[k] & 2) ? ')' : ']');
+}
+
+void Lanes::put(sym_t v, int l, const VarTable &x)
+{
+	LaneChunk &z = mut(v >> ENV_SHIFT);
+	size_t k = slot(v) + l;
+	if (x.empty())
+	{
+		z.lo[k] = INFINITY;
+		z.hi[k] = -INFINITY;
+		z.open[k] = 0;
+		return;
+	}
+	z.lo[k] = x.low;
+	z.hi[k] = x.up;
+	z.open[k] = (x.bound[0] == '(') + 2 * (x.bound[1] == ')');
+}
+
+void Lanes::copy(const Lanes &o, const uint8_t *mask)
+{
+	if (full(mask))
+	{
+		chunks = o.chunks;
+		return;
+	}
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (chunks[c] == o.chunks[c] || (!chunks[c] && !o.chunks[c]))
+			continue;
+		const LaneChunk &y = o.read(c);
+		LaneChunk &z = mut(c);
+		for (size_t k = 0; k < z.lo.size(); k += n)
+			for (int l = 0; l < n; ++l)
+				if (mask[l])
+				{
+					z.lo[k + l] = y.lo[k + l];
+					z.hi[k + l] = y.hi[k + l];
+					z.open[k + l] = y.open[k + l];
+				}
+	}
+}
+
+void Lanes::clear(const uint8_t *mask)
+{
+	if (full(mask))
+	{
+		fill(chunks.begin(), chunks.end(), nullptr);
+		return;
+	}
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (!chunks[c])
+			continue;
+		LaneChunk &z = mut(c);
+		for (size_t k = 0; k < z.lo.size(); k += n)
+			for (int l = 0; l < n; ++l)
+				if (mask[l])
+				{
+					z.lo[k + l] = INFINITY;
+					z.hi[k + l] = -INFINITY;
+					z.open[k + l] = 0;
+				}
+	}
+}
+
+void Lanes::join(const Lanes &o, const uint8_t *mask)
+{
+	/* with empties kept as (inf, -inf), join is min and max and goes without branches */
+	bool all = full(mask);
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (chunks[c] == o.chunks[c] || !o.chunks[c])
+			continue;
+		if (!chunks[c] && all)
+		{
+			chunks[c] = o.chunks[c];
+			continue;
+		}
+		const LaneChunk &y = *o.chunks[c];
+		const LaneChunk &x = read(c);
+		bool moved = false;
+		for (size_t k = 0; k < x.lo.size(); k += n)
+			for (int l = 0; l < n; ++l)
+			{
+				size_t j = k + l;
+				moved = moved || (mask[l] && (y.lo[j] < x.lo[j] || y.hi[j] > x.hi[j]
+					|| (y.lo[j] == x.lo[j] && (x.open[j] & 1) && !(y.open[j] & 1))
+					|| (y.hi[j] == x.hi[j] && (x.open[j] & 2) && !(y.open[j] & 2))));
+			}
+		if (!moved)
+			continue;
+		LaneChunk &z = mut(c);
+		for (size_t k = 0; k < z.lo.size(); k += n)
+			for (int l = 0; l < n; ++l)
+			{
+				size_t j = k + l;
+				double olo = y.lo[j], ohi = y.hi[j];
+				uint8_t oo = y.open[j], mine = z.open[j];
+				bool to_lo = mask[l] && (olo < z.lo[j] || (olo == z.lo[j] && !(oo & 1)));
+				bool to_hi = mask[l] && (ohi > z.hi[j] || (ohi == z.hi[j] && !(oo & 2)));
+				z.lo[j] = to_lo ? olo : z.lo[j];
+				z.hi[j] = to_hi ? ohi : z.hi[j];
+				z.open[j] = ((to_lo ? oo : mine) & 1) | ((to_hi ? oo : mine) & 2);
+			}
+		/* what came out as o's chunk is shared with it again */
+		if (all && z == y)
+			chunks[c] = o.chunks[c];
+	}
+}
+
+/* as VarTable::widen and VarTable::narrow, lane by lane */
+void Lanes::widen(const Lanes &o, const uint8_t *mask, const vector<DATA_TYPE> &types, const vector<double> &steps)
+{
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (chunks[c] == o.chunks[c] || !o.chunks[c])
+			continue;
+		const LaneChunk &y = *o.chunks[c];
+		LaneChunk &z = mut(c);
+		for (size_t k = 0, v = c * ENV_WIDTH; k < z.lo.size(); k += n, ++v)
+			for (int l = 0; l < n; ++l)
+			{
+				size_t j = k + l;
+				if (!mask[l] || y.empty(j))
+					continue;
+				if (z.empty(j))
+				{
+					z.lo[j] = y.lo[j];
+					z.hi[j] = y.hi[j];
+					z.open[j] = y.open[j];
+					continue;
+				}
+				if (y.lo[j] < z.lo[j] || (y.lo[j] == z.lo[j] && (z.open[j] & 1) && !(y.open[j] & 1)))
+				{
+					auto t = upper_bound(steps.begin(), steps.end(), y.lo[j]);
+					z.lo[j] = t != steps.begin() ? *(t - 1) : -INFINITY;
+					z.open[j] &= ~1;
+				}
+				if (y.hi[j] > z.hi[j] || (y.hi[j] == z.hi[j] && (z.open[j] & 2) && !(y.open[j] & 2)))
+				{
+					auto t = lower_bound(steps.begin(), steps.end(), y.hi[j]);
+					z.hi[j] = t != steps.end() ? *t : INFINITY;
+					z.open[j] &= ~2;
+				}
+				fit_lane(z.lo[j], z.hi[j], z.open[j], types[v]);
+			}
+	}
+}
+
+void Lanes::narrow(const Lanes &o, const uint8_t *mask, const vector<DATA_TYPE> &types, const vector<double> &steps)
+{
+	auto lost = [&steps](double end) {
+		return std::isinf(end) || binary_search(steps.begin(), steps.end(), end);
+	};
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (chunks[c] == o.chunks[c] || !chunks[c])
+			continue;
+		const LaneChunk &y = o.read(c);
+		LaneChunk &z = mut(c);
+		for (size_t k = 0, v = c * ENV_WIDTH; k < z.lo.size(); k += n, ++v)
+			for (int l = 0; l < n; ++l)
+			{
+				size_t j = k + l;
+				if (!mask[l])
+					continue;
+				if (y.empty(j))
+				{
+					z.lo[j] = INFINITY;
+					z.hi[j] = -INFINITY;
+					z.open[j] = 0;
+					continue;
+				}
+				if (z.empty(j))
+					continue;
+				if (lost(z.lo[j]) && (y.lo[j] > z.lo[j] || (y.lo[j] == z.lo[j] && (y.open[j] & 1))))
+				{
+					z.lo[j] = y.lo[j];
+					z.open[j] = (z.open[j] & ~1) | (y.open[j] & 1);
+				}
+				if (lost(z.hi[j]) && (y.hi[j] < z.hi[j] || (y.hi[j] == z.hi[j] && (y.open[j] & 2))))
+				{
+					z.hi[j] = y.hi[j];
+					z.open[j] = (z.open[j] & ~2) | (y.open[j] & 2);
+				}
+				fit_lane(z.lo[j], z.hi[j], z.open[j], types[v]);
+			}
+	}
+}
+
+bool Lanes::same(const Lanes &o, int l) const
+{
+	for (size_t c = 0; c < chunks.size(); ++c)
+	{
+		if (chunks[c] == o.chunks[c])
+			continue;
+		const LaneChunk &x = read(c), &y = o.read(c);
+		for (size_t j = l; j < x.lo.size(); j += n)
+			if (x.lo[j] != y.lo[j] || x.hi[j] != y.hi[j] || x.open[j] != y.open[j])
+				return false;
+	}
+	return true;
+}
+
+/*
+ * the ends of a op b over n lanes, into lo and hi; what the empty operands
+ * and open ends make of them is settled after, lane by lane
+ */
+void lanes_add(const double *alo, const double *ahi, const double *blo, const double *bhi, double *lo, double *hi, int n)
+{
+	int l = 0;
+#if defined(__AVX2__)
+	for (; l + 4 <= n; l += 4)
+	{
+		_mm256_storeu_pd(lo + l, _mm256_add_pd(_mm256_loadu_pd(alo + l), _mm256_loadu_pd(blo + l)));
+		_mm256_storeu_pd(hi + l, _mm256_add_pd(_mm256_loadu_pd(ahi + l), _mm256_loadu_pd(bhi + l)));
+	}
+#elif defined(__SSE2__)
+	for (; l + 2 <= n; l += 2)
+	{
+		_mm_storeu_pd(lo + l, _mm_add_pd(_mm_loadu_pd(alo + l), _mm_loadu_pd(blo + l)));
+		_mm_storeu_pd(hi + l, _mm_add_pd(_mm_loadu_pd(ahi + l), _mm_loadu_pd(bhi + l)));
+	}
+#endif
+	for (; l < n; ++l)
+	{
+		lo[l] = alo[l] + blo[l];
+		hi[l] = ahi[l] + bhi[l];
+	}
+}
+
+void lanes_sub(const double *alo, const double *ahi, const double *blo, const double *bhi, double *lo, double *hi, int n)
+{
+	int l = 0;
+#if defined(__AVX2__)
+	for (; l + 4 <= n; l += 4)
+	{
+		_mm256_storeu_pd(lo + l, _mm256_sub_pd(_mm256_loadu_pd(alo + l), _mm256_loadu_pd(bhi + l)));
+		_mm256_storeu_pd(hi + l, _mm256_sub_pd(_mm256_loadu_pd(ahi + l), _mm256_loadu_pd(blo + l)));
+	}
+#elif defined(__SSE2__)
+	for (; l + 2 <= n; l += 2)
+	{
+		_mm_storeu_pd(lo + l, _mm_sub_pd(_mm_loadu_pd(alo + l), _mm_loadu_pd(bhi + l)));
+		_mm_storeu_pd(hi + l, _mm_sub_pd(_mm_loadu_pd(ahi + l), _mm_loadu_pd(blo + l)));
+	}
+#endif
+	for (; l < n; ++l)
+	{
+		lo[l] = alo[l] - bhi[l];
+		hi[l] = ahi[l] - blo[l];
+	}
+}
+
+#if defined(__AVX2__)
+/* x * y with 0 * inf taken as 0, as mul_end */
+inline __m256d mul_end4(__m256d x, __m256d y)
+{
+	__m256d zero = _mm256_setzero_pd();
+	__m256d either = _mm256_or_pd(_mm256_cmp_pd(x, zero, _CMP_EQ_OQ), _mm256_cmp_pd(y, zero, _CMP_EQ_OQ));
+	return _mm256_andnot_pd(either, _mm256_mul_pd(x, y));
+}
+#elif defined(__SSE2__)
+inline __m128d mul_end2(__m128d x, __m128d y)
+{
+	__m128d zero = _mm_setzero_pd();
+	__m128d either = _mm_or_pd(_mm_cmpeq_pd(x, zero), _mm_cmpeq_pd(y, zero));
+	return _mm_andnot_pd(either, _mm_mul_pd(x, y));
+}
+#endif
+
+void lanes_mul(const double *alo, const double *ahi, const double *blo, const double *bhi, double *lo, double *hi, int n)
+{
+	int l = 0;
+#if defined(__AVX2__)
+	for (; l + 4 <= n; l += 4)
+	{
+		__m256d xl = _mm256_loadu_pd(alo + l), xu = _mm256_loadu_pd(ahi + l);
+		__m256d yl = _mm256_loadu_pd(blo + l), yu = _mm256_loadu_pd(bhi + l);
+		__m256d c0 = mul_end4(xl, yl), c1 = mul_end4(xl, yu), c2 = mul_end4(xu, yl), c3 = mul_end4(xu, yu);
+		_mm256_storeu_pd(lo + l, _mm256_min_pd(_mm256_min_pd(c0, c1), _mm256_min_pd(c2, c3)));
+		_mm256_storeu_pd(hi + l, _mm256_max_pd(_mm256_max_pd(c0, c1), _mm256_max_pd(c2, c3)));
+	}
+#elif defined(__SSE2__)
+	for (; l + 2 <= n; l += 2)
+	{
+		__m128d xl = _mm_loadu_pd(alo + l), xu = _mm_loadu_pd(ahi + l);
+		__m128d yl = _mm_loadu_pd(blo + l), yu = _mm_loadu_pd(bhi + l);
+		__m128d c0 = mul_end2(xl, yl), c1 = mul_end2(xl, yu), c2 = mul_end2(xu, yl), c3 = mul_end2(xu, yu);
+		_mm_storeu_pd(lo + l, _mm_min_pd(_mm_min_pd(c0, c1), _mm_min_pd(c2, c3)));
+		_mm_storeu_pd(hi + l, _mm_max_pd(_mm_max_pd(c0, c1), _mm_max_pd(c2, c3)));
+	}
+#endif
+	for (; l < n; ++l)
+	{
+		double c[4] = { mul_end(alo[l], blo[l]), mul_end(alo[l], bhi[l]), mul_end(ahi[l], blo[l]), mul_end(ahi[l], bhi[l]) };
+		lo[l] = *min_element(c, c + 4);
+		hi[l] = *max_element(c, c + 4);
+	}
+}
+
+/* an integer lane end the doubles hold exactly, as Interval<INT> would;
+ * 2^53 itself may be 2^53 + 1 rounded to even */
+inline bool exact_whole(double x)
+{
+	return fabs(x) < 0x1p53 || std::isinf(x);
+}
+
+class LaneSolver
+{
+	FuncTable *func;
+	CallResolver *calls;
+	int n;					// lanes
+	vector<DATA_TYPE> types;	// by var
+	const vector<BlockTable*> &order;	// of func->flow
+	const EdgeRows &succ;
+	const EdgeRows &pred;
+	const vector<bool> &header;
+	const vector<double> &thresholds;
+	vector<Lanes> in;			// by block index
+	vector<Lanes> out;
+	Lanes start;
+	Lanes scratch;
+	Lanes back;
+	Lanes wide;
+	/* by block index * n + lane */
+	vector<uint8_t> in_reach;
+	vector<uint8_t> out_reach;
+	vector<uint8_t> done;
+	vector<uint8_t> queued;
+	vector<int> widens;
+	vector<int> narrows;
+	/* by lane, for the block being visited */
+	vector<uint8_t> reach;
+	vector<uint8_t> looped;
+	vector<uint8_t> kind;
+	vector<uint8_t> live;
+	vector<uint8_t> m;
+	/* operands of one statement over the lanes, read in place or spread out here */
+	const double *a_lo[2];
+	const double *a_hi[2];
+	const uint8_t *a_open[2];
+	vector<double> op_lo[2];
+	vector<double> op_hi[2];
+	vector<uint8_t> op_open[2];
+	vector<double> res_lo;
+	vector<double> res_hi;
+	vector<VarTable> actuals;
+	static const int widen_delay = 2;
+	static const int threshold_steps = 2;	// widenings stopped at a threshold, the next go to infinity
+	static const int narrow_limit = 2;
+
+	bool tracked(sym_t a)
+	{
+		return a >= 0 && func->vars[a] != nullptr;
+	}
+	DATA_TYPE type_of(sym_t a)
+	{
+		if (is_constant(a))
+			return func->consts[~a].type;
+		return tracked(a) ? func->vars[a]->type : FLOAT;
+	}
+	void load(int k, sym_t a, const Lanes &env);
+	VarTable eval(sym_t a, const Lanes &env, int l);
+	void assign(sym_t a, Lanes &env, int l, const VarTable &v);
+	void run(bool narrowing);
+	void visit(int b, bool narrowing, vector<uint8_t> &act);
+	void transfer(BlockTable *blk, Lanes &env, vector<uint8_t> &live, bool record);
+public:
+	long long iterations = 0;
+	vector<VarTable> ret;		// by lane, joined over the reachable returns
+	vector<uint8_t> returned;
+	LaneSolver(FuncTable *_func, CallResolver *_calls, int lanes) : func(_func), calls(_calls), n(lanes),
+		order(_func->flow.order), succ(_func->flow.succ), pred(_func->flow.pred), header(_func->flow.header),
+		thresholds(_func->flow.thresholds) {}
+	void solve(const vector<vector<VarTable>> &args);
+	VarTable hull(sym_t v, int l);
+};
+
+/* operand a of every lane into a_*[k], as RangeSolver::eval reads it */
+void LaneSolver::load(int k, sym_t a, const Lanes &env)
+{
+	if (tracked(a))
+	{
+		const LaneChunk &x = env.of(a);
+		size_t at = env.slot(a);
+		a_lo[k] = x.lo.data() + at;
+		a_hi[k] = x.hi.data() + at;
+		a_open[k] = x.open.data() + at;
+		return;
+	}
+	VarTable v(NO_SYM, FLOAT);
+	if (is_constant(a))
+		v = func->consts[~a];
+	op_lo[k].assign(n, v.low);
+	op_hi[k].assign(n, v.up);
+	op_open[k].assign(n, (v.bound[0] == '(') + 2 * (v.bound[1] == ')'));
+	a_lo[k] = op_lo[k].data();
+	a_hi[k] = op_hi[k].data();
+	a_open[k] = op_open[k].data();
+}
+
+VarTable LaneSolver::eval(sym_t a, const Lanes &env, int l)
+{
+	if (is_constant(a))
+		return func->consts[~a];
+	if (!tracked(a))
+		return VarTable(NO_SYM, FLOAT);
+	return env.get(a, l, func->vars[a]->type);
+}
+
+void LaneSolver::assign(sym_t a, Lanes &env, int l, const VarTable &v)
+{
+	if (tracked(a))
+		env.put(a, l, v);
+}
+
+void LaneSolver::transfer(BlockTable *blk, Lanes &env, vector<uint8_t> &live, bool record)
+{
+	/* live loses the lanes where a guard can not hold */
+	const Instr *s = func->code.data() + blk->first;
+	for (const Instr *end = s + blk->count; s != end; ++s)
+	{
+		if (s->op == CALL)
+		{
+			actuals.resize(s->count);
+			for (int l = 0; l < n; ++l)
+			{
+				if (!live[l])
+					continue;
+				VarTable res(NO_SYM, FLOAT);
+				if (calls != nullptr)
+				{
+					for (int k = 0; k < s->count; ++k)
+						actuals[k] = eval(func->operands[s->first + k], env, l);
+					res = calls->call(s->arg1, actuals);
+				}
+				if (tracked(s->result))
+				{
+					res.type = func->vars[s->result]->type;
+					res.fit();
+				}
+				assign(s->result, env, l, res);
+			}
+			continue;
+		}
+		if (s->op >= GOTO_EQ && s->op <= GOTO_G)
+		{
+			for (int l = 0; l < n; ++l)
+			{
+				if (!live[l])
+					continue;
+				VarTable a = eval(s->arg1, env, l), b = eval(s->arg2, env, l);
+				if (!refine_guard(s->op, a, b))
+				{
+					live[l] = 0;
+					continue;
+				}
+				assign(s->arg1, env, l, a);
+				assign(s->arg2, env, l, b);
+			}
+			continue;
+		}
+		if (s->op == GOTO)
+			continue;
+		if (s->op == RETURN)
+		{
+			if (!record || s->result == NO_SYM)
+				continue;
+			for (int l = 0; l < n; ++l)
+			{
+				if (!live[l])
+					continue;
+				VarTable v = eval(s->result, env, l);
+				if (!returned[l])
+				{
+					ret[l] = v;
+					ret[l].set_empty();
+					returned[l] = 1;
+				}
+				ret[l].join(v);
+			}
+			continue;
+		}
+		if (!tracked(s->result))
+			continue;
+		DATA_TYPE type = func->vars[s->result]->type;
+		bool binary = s->op == ADD || s->op == SUB || s->op == MUL || s->op == DIV;
+		if (binary && (s->op == DIV || type == FLOAT || type_of(s->arg1) == FLOAT || type_of(s->arg2) == FLOAT))
+		{
+			/* floats round outward and division special cases too much to pay off in lanes */
+			for (int l = 0; l < n; ++l)
+			{
+				if (!live[l])
+					continue;
+				VarTable res(NO_SYM, type);
+				range_apply(s->op, eval(s->arg1, env, l), eval(s->arg2, env, l), res);
+				assign(s->result, env, l, res);
+			}
+			continue;
+		}
+		load(0, s->arg1, env);
+		res_lo.resize(n);
+		res_hi.resize(n);
+		if (binary)
+		{
+			load(1, s->arg2, env);
+			if (s->op == ADD)
+				lanes_add(a_lo[0], a_hi[0], a_lo[1], a_hi[1], res_lo.data(), res_hi.data(), n);
+			else if (s->op == SUB)
+				lanes_sub(a_lo[0], a_hi[0], a_lo[1], a_hi[1], res_lo.data(), res_hi.data(), n);
+			else
+				lanes_mul(a_lo[0], a_hi[0], a_lo[1], a_hi[1], res_lo.data(), res_hi.data(), n);
+		}
+		/* the operands stay readable, a chunk still shared is copied, not changed */
+		LaneChunk &z = env.mut(s->result >> ENV_SHIFT);
+		size_t at = env.slot(s->result);
+		for (int l = 0; l < n; ++l)
+		{
+			if (!live[l])
+				continue;
+			double lo = a_lo[0][l], hi = a_hi[0][l];
+			uint8_t x_open = a_open[0][l], open = x_open;
+			bool x_empty = lo > hi || (lo == hi && x_open != 0);
+			if (binary)
+			{
+				double blo = a_lo[1][l], bhi = a_hi[1][l];
+				uint8_t y_open = a_open[1][l];
+				if (x_empty || blo > bhi || (blo == bhi && y_open != 0))
+				{
+					lo = INFINITY;
+					hi = -INFINITY;
+					open = 0;
+				}
+				else if (!exact_whole(res_lo[l]) || !exact_whole(res_hi[l]))
+				{
+					/* past 2^53 doubles no longer hold every integer, saturate in int64 */
+					VarTable r(NO_SYM, type);
+					range_apply(s->op, eval(s->arg1, env, l), eval(s->arg2, env, l), r);
+					lo = r.low;
+					hi = r.up;
+					open = 0;
+				}
+				else
+				{
+					lo = res_lo[l];
+					hi = res_hi[l];
+					if (s->op == ADD)
+						open = x_open | y_open;
+					else if (s->op == SUB)
+						open = (x_open & 1) | ((y_open & 2) >> 1) | (x_open & 2) | ((y_open & 1) << 1);
+					else
+						open = 0;
+				}
+			}
+			else if (s->op == INT_CAST && !x_empty)
+			{
+				trunc_ends(lo, hi, x_open & 1, x_open & 2);
+				open = 0;
+			}
+			fit_lane(lo, hi, open, type);
+			z.lo[at + l] = lo;
+			z.hi[at + l] = hi;
+			z.open[at + l] = open;
+		}
+	}
+}
+
+void LaneSolver::visit(int b, bool narrowing, vector<uint8_t> &act)
+{
+	/* act holds the lanes queued at b, it is left with those whose OUT changed */
+	BlockTable *blk = order[b];
+	size_t at = (size_t)b * n;
+	bool around = false;		// some lane has values coming around a loop
+	fill(looped.begin(), looped.end(), 0);
+	if (b == 0)
+	{
+		scratch.copy(start, act.data());
+		reach = act;
+	}
+	else
+	{
+		scratch.clear(act.data());
+		fill(reach.begin(), reach.end(), 0);
+	}
+	for (auto p = pred[b].begin(); p != pred[b].end(); ++p)
+	{
+		bool any = false;
+		for (int l = 0; l < n; ++l)
+		{
+			m[l] = act[l] && out_reach[(size_t)*p * n + l];
+			reach[l] |= m[l];
+			any = any || m[l];
+		}
+		if (!any)
+			continue;
+		/* values coming around a loop are kept apart from those entering it */
+		if (*p < b)
+		{
+			scratch.join(out[*p], m.data());
+			continue;
+		}
+		if (!around)
+			back.clear(act.data());
+		around = true;
+		back.join(out[*p], m.data());
+		for (int l = 0; l < n; ++l)
+			looped[l] |= m[l];
+	}
+	/* each lane takes the branch of RangeSolver::visit it would alone */
+	enum {FIRST = 1, NARROW, WIDEN, LEAP, JOIN};	// LEAP widens past the thresholds
+	fill(kind.begin(), kind.end(), 0);
+	for (int l = 0; l < n; ++l)
+	{
+		act[l] = act[l] && reach[l];
+		if (!act[l])
+			continue;
+		iterations++;
+		if (!in_reach[at + l])
+			kind[l] = FIRST;
+		else if (header[b] && narrowing)
+			kind[l] = NARROW;
+		else if (header[b] && looped[l] && ++widens[at + l] > widen_delay)
+			kind[l] = widens[at + l] > widen_delay + threshold_steps ? LEAP : WIDEN;
+		else
+			kind[l] = JOIN;
+	}
+	Lanes &cur = in[b];
+	for (int k = FIRST; k <= JOIN; ++k)
+	{
+		bool any = false;
+		for (int l = 0; l < n; ++l)
+		{
+			m[l] = kind[l] == k;
+			any = any || m[l];
+		}
+		if (!any)
+			continue;
+		if (k == WIDEN || k == LEAP)
+		{
+			/* only growth around the loop is widened */
+			wide.copy(cur, m.data());
+			wide.widen(back, m.data(), types, k == WIDEN ? thresholds : vector<double>());
+			scratch.join(wide, m.data());
+		}
+		else if (around)
+			scratch.join(back, m.data());
+		if (k == JOIN && header[b] && !narrowing)
+			scratch.join(cur, m.data());
+		for (int l = 0; l < n; ++l)
+		{
+			if (!m[l])
+				continue;
+			if (k == NARROW)
+			{
+				if (narrows[at + l] >= narrow_limit || scratch.same(cur, l))
+				{
+					m[l] = 0;
+					if (done[at + l])
+						act[l] = 0;
+				}
+				else
+					narrows[at + l]++;
+			}
+			else if (k != FIRST && scratch.same(cur, l) && done[at + l])
+			{
+				m[l] = 0;
+				act[l] = 0;
+			}
+		}
+		if (k == NARROW)
+			cur.narrow(scratch, m.data(), types, thresholds);
+		else
+			cur.copy(scratch, m.data());
+	}
+	for (int l = 0; l < n; ++l)
+		if (act[l])
+			in_reach[at + l] = done[at + l] = 1;
+	scratch.copy(cur, act.data());
+	live = act;
+	transfer(blk, scratch, live, false);
+	bool dropped = false;
+	for (int l = 0; l < n; ++l)
+	{
+		m[l] = 0;
+		if (!act[l])
+			continue;
+		if (!live[l])
+		{
+			if (!out_reach[at + l])
+				act[l] = 0;
+			out_reach[at + l] = 0;
+			dropped = true;
+		}
+		else if (out_reach[at + l] && scratch.same(out[b], l))
+			act[l] = 0;
+		else
+		{
+			out_reach[at + l] = 1;
+			m[l] = 1;
+		}
+	}
+	if (dropped)
+		out[b].clear(act.data());
+	out[b].copy(scratch, m.data());
+}
+
+void LaneSolver::run(bool narrowing)
+{
+	/* blocks in order, each lane takes those queued for it */
+	priority_queue<int, vector<int>, greater<int>> work;
+	vector<bool> listed(order.size(), false);
+	int first = narrowing ? order.size() : 1;
+	for (int b = 0; b < first; ++b)
+	{
+		work.push(b);
+		listed[b] = true;
+		fill(queued.begin() + (size_t)b * n, queued.begin() + (size_t)(b + 1) * n, 1);
+	}
+	vector<uint8_t> act(n);
+	while (!work.empty())
+	{
+		int b = work.top();
+		work.pop();
+		listed[b] = false;
+		copy(queued.begin() + (size_t)b * n, queued.begin() + (size_t)(b + 1) * n, act.begin());
+		fill(queued.begin() + (size_t)b * n, queued.begin() + (size_t)(b + 1) * n, 0);
+		visit(b, narrowing, act);
+		for (auto s = succ[b].begin(); s != succ[b].end(); ++s)
+		{
+			bool any = false;
+			for (int l = 0; l < n; ++l)
+				if (act[l])
+				{
+					queued[(size_t)*s * n + l] = 1;
+					any = true;
+				}
+			if (any && !listed[*s])
+			{
+				listed[*s] = true;
+				work.push(*s);
+			}
+		}
+	}
+}
+
+void LaneSolver::solve(const vector<vector<VarTable>> &args)
+{
+	/* args holds the parameter ranges of each lane, as RangeSolver::solve(args) takes them */
+	sym_t n_vars = func->vars.size();
+	types.assign((n_vars + ENV_MASK) & ~ENV_MASK, FLOAT);
+	for (sym_t i = 0; i < n_vars; ++i)
+		if (func->vars[i] != nullptr)
+			types[i] = func->vars[i]->type;
+	ret.assign(n, VarTable());
+	returned.assign(n, 0);
+	int blocks = order.size();
+	start.reset(n_vars, n);
+	for (sym_t i = 0; i < n_vars; ++i)
+		if (func->vars[i] != nullptr)
+			for (int l = 0; l < n; ++l)
+				start.put(i, l, *func->vars[i]);
+	for (int l = 0; l < n && l < args.size(); ++l)
+		for (int i = 0; i < args[l].size() && i < func->args.size(); ++i)
+		{
+			VarTable v = args[l][i];
+			v.type = func->vars[func->args[i]]->type;
+			v.fit();
+			start.put(func->args[i], l, v);
+		}
+	scratch.reset(n_vars, n);
+	back.reset(n_vars, n);
+	wide.reset(n_vars, n);
+	in.assign(blocks, scratch);
+	out.assign(blocks, scratch);
+	in_reach.assign((size_t)blocks * n, 0);
+	out_reach.assign((size_t)blocks * n, 0);
+	done.assign((size_t)blocks * n, 0);
+	queued.assign((size_t)blocks * n, 0);
+	widens.assign((size_t)blocks * n, 0);
+	narrows.assign((size_t)blocks * n, 0);
+	reach.assign(n, 0);
+	looped.assign(n, 0);
+	kind.assign(n, 0);
+	live.assign(n, 0);
+	m.assign(n, 0);
+	if (blocks == 0)
+		return;
+	run(false);
+	fill(done.begin(), done.end(), 0);
+	run(true);
+	/* returned ranges are read off the final states */
+	for (int b = 0; b < blocks; ++b)
+	{
+		for (int l = 0; l < n; ++l)
+			live[l] = in_reach[(size_t)b * n + l];
+		scratch.copy(in[b], live.data());
+		transfer(order[b], scratch, live, true);
+	}
+}
+
+/* what v holds anywhere in the function, in lane l */
+VarTable LaneSolver::hull(sym_t v, int l)
+{
+	VarTable h(v, types[v]);
+	h.set_empty();
+	for (int b = 0; b < order.size(); ++b)
+	{
+		if (in_reach[(size_t)b * n + l])
+			h.join(in[b].get(v, l, types[v]));
+		if (out_reach[(size_t)b * n + l])
+			h.join(out[b].get(v, l, types[v]));
+	}
+	return h;
+}
+
+/* one set of parameter ranges for --scenarios, by parameter name */
+typedef vector<pair<string, VarTable>> Scenario;
+
+/*
+ * a scenario is a line of name=[low,up] settings, either end may be open
+ * or inf. blank lines and lines from # on are skipped. false with the
+ * line number in bad when a setting does not read
+ */
+bool read_scenarios(const string &path, vector<Scenario> &out, int &bad)
+{
+	ifstream in(path);
+	if (!in)
+		return false;
+	string line;
+	for (bad = 1; getline(in, line); ++bad)
+	{
+		line = line.substr(0, line.find('#'));
+		istringstream words(line);
+		string w;
+		Scenario s;
+		while (words >> w)
+		{
+			size_t eq = w.find('=');
+			if (eq == string::npos || eq == 0 || eq + 1 >= w.size())
+				return false;
+			const char *p = w.c_str() + eq + 1;
+			char *end;
+			char lb = *p++;
+			double low = strtod(p, &end);
+			if ((lb != '[' && lb != '(') || end == p || *end != ',')
+				return false;
+			p = end + 1;
+			double up = strtod(p, &end);
+			char ub = *end;
+			if (end == p || (ub != ']' && ub != ')') || end[1] != '\0')
+				return false;
+			s.push_back(make_pair(w.substr(0, eq), VarTable(NO_SYM, FLOAT, low, up, lb, ub)));
+		}
+		if (!s.empty())
+			out.push_back(s);
+	}
+	bad = 0;
+	return true;
+}
+
+/* a --query: the range of var where block of func begins */
+class Query
+{
+public:
+	string func;
+	string block;
+	string var;
+};
+
+/* func:block:var, the block may hold spaces and colons but no end may be empty */
+bool read_query(const string &text, Query &q)
+{
+	size_t a = text.find(':'), b = text.rfind(':');
+	if (a == string::npos || a == 0 || b <= a + 1 || b + 1 == text.size())
+		return false;
+	q.func = text.substr(0, a);
+	q.block = text.substr(a + 1, b - a - 1);
+	q.var = text.substr(b + 1);
+	return true;
+}
+
+/* what is kept of a function once it is solved and its tables are freed */
+class FuncSummary
+{
+public:
+	bool defined = false;
+	int args = 0;
+	VarTable ret;		// empty when it never returns
+};
+
+/* what an earlier run concluded about a function, reused while its key holds */
+class FuncResult
+{
+public:
+	VarTable ret;
+	vector<myError> errors;
+	string text;		// as drawn
+};
+
+uint64_t content_hash(const char *data, size_t size);
+uint64_t fingerprint(FuncTable *f, const SymbolTable &callees);
+class WorkPool;
+
+class GlobalTable
+{
+	vector<myError> errors;		// of functions already freed
+	/* for queries: the graph of each function asked about, and the call
+	 * graph to find the callees to solve before it */
+	vector<unique_ptr<SparseSolver>> asked;
+	unique_ptr<CallResolver> answering;
+	vector<vector<sym_t>> asked_callees;
+	vector<vector<sym_t>> asked_sccs;
+	vector<int> asked_scc_of;
+	void summarize(FuncTable *f);
+	void settle_callees(sym_t func);
+public:
+	SymbolTable names;
+	vector<FuncTable*> funcs;	// by function id, nullptr for callees never defined
+	vector<FuncSummary> summaries;	// by function id, filled as functions are solved
+	/*
+	 * when streaming, each function is solved, drawn to sink and freed as
+	 * soon as the parser finishes it, so only one is alive at a time.
+	 * functions then come out in definition order rather than by name.
+	 */
+	bool streaming = false;
+	Emitter *sink = nullptr;
+	EmitOptions options;		// how results are drawn
+	ENGINE engine = EN_DENSE;
+	Budget budget;				// of each solve of a function
+	function<void(FuncTable*)> keep;	// sees each streamed function before it is freed
+	/*
+	 * incremental runs hand in the results of an earlier one. a function is
+	 * keyed by its own body and the keys of everything it calls, so an scc
+	 * whose keys are all known is taken over instead of solved
+	 */
+	const unordered_map<uint64_t, FuncResult> *prior = nullptr;
+	vector<uint64_t> keys;		// by function id
+	vector<string> drawn;		// by function id, text of functions drawn already
+	atomic<int> reused{0};
+	atomic<long long> iterations{0};	// of the solvers, over all functions
+	Stats *stats = nullptr;		// kept when not null
+	long long* timer(PHASE p)
+	{
+		return stats != nullptr ? &stats->ns[p] : nullptr;
+	}
+	sym_t intern(string_view fname)
+	{
+		sym_t id = names.intern(fname);
+		if (id == funcs.size())
+		{
+			funcs.push_back(nullptr);
+			summaries.push_back(FuncSummary());
+		}
+		return id;
+	}
+	GlobalTable() {}
+	GlobalTable(const GlobalTable&) = delete;
+	GlobalTable& operator=(const GlobalTable&) = delete;
+	~GlobalTable()
+	{
+		/* each function releases its arena with it, after the graphs over it */
+		asked.clear();
+		for (auto i = funcs.begin(); i != funcs.end(); ++i)
+			delete *i;
+	}
+	FuncTable* put(string_view fname)
+	{
+		FuncTable *tmp = new FuncTable();
+		tmp->func_name = string(fname);
+		sym_t id = intern(fname);
+		tmp->id = id;
+		delete funcs[id];
+		funcs[id] = tmp;
+		return tmp;
+	}
+	void finish(FuncTable *f);
+	void call_graph(vector<vector<sym_t>> &callees);
+	void order_sccs(const vector<vector<sym_t>> &callees, vector<vector<sym_t>> &sccs);
+	void solve_scc(const vector<sym_t> &members, bool recursive, CallResolver &calls);
+	void key_sccs(WorkPool &pool, const vector<vector<sym_t>> &sccs, const vector<vector<sym_t>> &callees, const vector<int> &scc_of);
+	bool reuse(const vector<sym_t> &members, CallResolver &calls);
+	void remember(unordered_map<uint64_t, FuncResult> &out);
+	void analyze(int threads = 0);
+	void collect(vector<myError> &errors);
+	void draw(const string &path);
+	void draw_scenarios(const string &path, const vector<Scenario> &scenarios, int threads);
+	VarTable query(sym_t func, sym_t block, sym_t var);
+	string resolve(const Query &q, sym_t &func, sym_t &block, sym_t &var);
+	void answer(const vector<Query> &queries, vector<VarTable> &out);
+	void draw_queries(const string &path, const vector<Query> &queries, const vector<VarTable> &answers);
+};
+
+/*
+ * a fixed set of workers, each with its own deque of tasks. a worker takes
+ * from the back of its own deque and, once that runs dry, steals from the
+ * front of the others. every task is dealt out before the workers start,
+ * so a worker that finds all deques empty is done.
+ */
+class WorkPool
+{
+	class Queue
+	{
+	public:
+		mutex lock;
+		deque<int> tasks;
+	};
+	unique_ptr<Queue[]> queues;
+	bool take(int self, int &task);
+public:
+	int threads;
+	WorkPool(int _threads);
+	void run(const vector<int> &tasks, const function<void(int)> &job);
+};
+
+WorkPool::WorkPool(int _threads)
+{
+	threads = _threads > 0 ? _threads : thread::hardware_concurrency();
+	if (threads < 1)
+		threads = 1;
+	queues.reset(new Queue[threads]);
+}
+
+bool WorkPool::take(int self, int &task)
+{
+	for (int k = 0; k < threads; ++k)
+	{
+		int victim = (self + k) % threads;
+		Queue &q = queues[victim];
+		lock_guard<mutex> hold(q.lock);
+		if (q.tasks.empty())
+			continue;
+		if (victim == self)
+		{
+			task = q.tasks.back();
+			q.tasks.pop_back();
+		}
+		else
+		{
+			task = q.tasks.front();
+			q.tasks.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+void WorkPool::run(const vector<int> &tasks, const function<void(int)> &job)
+{
+	int n = min<int>(threads, tasks.size());
+	if (n <= 1)
+	{
+		for (auto i = tasks.begin(); i != tasks.end(); ++i)
+			job(*i);
+		return;
+	}
+	/* dealt round robin, so each worker starts with the earliest of its share */
+	for (int i = tasks.size() - 1; i >= 0; --i)
+		queues[i % n].tasks.push_back(tasks[i]);
+	vector<thread> workers;
+	for (int w = 0; w < n; ++w)
+	{
+		workers.push_back(thread([this, w, &job]() {
+			int task;
+			while (take(w, task))
+				job(task);
+		}));
+	}
+	for (auto i = workers.begin(); i != workers.end(); ++i)
+		i->join();
+}
+
+void GlobalTable::summarize(FuncTable *f)
+{
+	FuncSummary &s = summaries[f->id];
+	s.defined = true;
+	s.args = f->args.size();
+	if (f->ret != nullptr)
+		s.ret = *f->ret;
+	else
+		s.ret = VarTable();
+}
+
+void GlobalTable::finish(FuncTable *f)
+{
+	/* called by the parser once f is complete, only streaming acts on it */
+	if (!streaming)
+		return;
+	{
+		/* the solver holds environments of f, it goes first. callees seen
+		 * so far answer with their summaries */
+		Stopwatch w(timer(PH_SOLVE));
+		CallResolver calls(*this);
+		iterations += solve_with(engine, f, &calls, budget);
+	}
+	if (keep)
+		keep(f);
+	if (stats != nullptr)
+		stats->add(f);
+	if (sink != nullptr)
+	{
+		Stopwatch w(timer(PH_DRAW));
+		f->draw(*sink, names);
+		sink->done();
+	}
+	summarize(f);
+	errors.insert(errors.end(), f->errors.begin(), f->errors.end());
+	funcs[f->id] = nullptr;
+	delete f;
+}
+
+void GlobalTable::analyze(int threads)
+{
+	if (streaming)
+	{
+		/* only functions the input left unterminated are still here */
+		for (auto i = funcs.begin(); i != funcs.end(); ++i)
+			if (*i != nullptr)
+				finish(*i);
+		return;
+	}
+	/*
+	 * callees are solved before their callers. sccs of the call graph are
+	 * the tasks, those on one level only call lower levels, so a level runs
+	 * in parallel once the one below it is done
+	 */
+	vector<vector<sym_t>> callees, sccs;
+	call_graph(callees);
+	order_sccs(callees, sccs);
+	vector<int> scc_of(funcs.size(), -1), level(sccs.size(), 0);
+	vector<bool> recursive(sccs.size(), false);
+	vector<size_t> weight(sccs.size(), 0);
+	int levels = 0;
+	for (int c = 0; c < sccs.size(); ++c)
+	{
+		recursive[c] = sccs[c].size() > 1;
+		for (auto m = sccs[c].begin(); m != sccs[c].end(); ++m)
+			scc_of[*m] = c;
+		for (auto m = sccs[c].begin(); m != sccs[c].end(); ++m)
+		{
+			for (auto to = callees[*m].begin(); to != callees[*m].end(); ++to)
+			{
+				if (scc_of[*to] == c)
+					recursive[c] = true;
+				else
+					level[c] = max(level[c], level[scc_of[*to]] + 1);
+			}
+			for (auto b = funcs[*m]->blocks.begin(); b != funcs[*m]->blocks.end(); ++b)
+				if (*b != nullptr)
+					weight[c] += (*b)->count + 1;
+		}
+		levels = max(levels, level[c] + 1);
+	}
+	vector<vector<int>> tasks(levels);
+	for (int c = 0; c < sccs.size(); ++c)
+		tasks[level[c]].push_back(c);
+	CallResolver calls(*this);
+	calls.settled.assign(funcs.size(), 0);
+	drawn.assign(funcs.size(), string());
+	WorkPool pool(threads);
+	if (prior != nullptr)
+		key_sccs(pool, sccs, callees, scc_of);
+	for (int l = 0; l < levels; ++l)
+	{
+		/* the biggest go first to keep the tail short */
+		stable_sort(tasks[l].begin(), tasks[l].end(), [&weight](int a, int b) { return weight[a] > weight[b]; });
+		pool.run(tasks[l], [this, &sccs, &recursive, &calls](int c) {
+			if (prior == nullptr || !reuse(sccs[c], calls))
+				solve_scc(sccs[c], recursive[c], calls);
+		});
+	}
+}
+
+void GlobalTable::key_sccs(WorkPool &pool, const vector<vector<sym_t>> &sccs, const vector<vector<sym_t>> &callees, const vector<int> &scc_of)
+{
+	/* parts are hashed sorted by value, ids depend on where things are in the file */
+	vector<uint64_t> own(funcs.size(), 0), scc_key(sccs.size(), 0);
+	vector<int> defined;
+	for (sym_t i = 0; i < funcs.size(); ++i)
+		if (funcs[i] != nullptr)
+			defined.push_back(i);
+	pool.run(defined, [this, &own](int i) { own[i] = fingerprint(funcs[i], names); });
+	keys.assign(funcs.size(), 0);
+	for (int c = 0; c < sccs.size(); ++c)
+	{
+		vector<uint64_t> parts, below;
+		for (auto m = sccs[c].begin(); m != sccs[c].end(); ++m)
+		{
+			parts.push_back(own[*m]);
+			for (auto to = callees[*m].begin(); to != callees[*m].end(); ++to)
+				if (scc_of[*to] != c)
+					below.push_back(scc_key[scc_of[*to]]);
+		}
+		sort(parts.begin(), parts.end());
+		sort(below.begin(), below.end());
+		below.erase(unique(below.begin(), below.end()), below.end());
+		parts.insert(parts.end(), below.begin(), below.end());
+		scc_key[c] = content_hash((const char*)parts.data(), parts.size() * sizeof(uint64_t));
+		for (auto m = sccs[c].begin(); m != sccs[c].end(); ++m)
+		{
+			uint64_t both[2] = {scc_key[c], own[*m]};
+			keys[*m] = content_hash((const char*)both, sizeof(both));
+		}
+	}
+}
+
+bool GlobalTable::reuse(const vector<sym_t> &members, CallResolver &calls)
+{
+	/* an scc is taken over whole or solved whole */
+	vector<const FuncResult*> found;
+	for (auto m = members.begin(); m != members.end(); ++m)
+	{
+		auto i = prior->find(keys[*m]);
+		if (i == prior->end())
+			return false;
+		found.push_back(&i->second);
+	}
+	for (int k = 0; k < members.size(); ++k)
+	{
+		sym_t m = members[k];
+		FuncTable *f = funcs[m];
+		summaries[m].defined = true;
+		summaries[m].args = f->args.size();
+		summaries[m].ret = found[k]->ret;
+		/* only the line of the function may have moved */
+		f->errors = found[k]->errors;
+		for (auto e = f->errors.begin(); e != f->errors.end(); ++e)
+		{
+			e->set(e->kind(), e->what(), f->line);
+			f->approximate = f->approximate || e->warning();
+		}
+		drawn[m] = found[k]->text;
+		calls.settled[m] = 1;
+	}
+	reused += members.size();
+	return true;
+}
+
+void GlobalTable::remember(unordered_map<uint64_t, FuncResult> &out)
+{
+	/* functions solved this run are drawn here, draw then copies the text */
+	for (sym_t i = 0; i < funcs.size(); ++i)
+	{
+		if (funcs[i] == nullptr)
+			continue;
+		if (drawn[i].empty())
+		{
+			Emitter text(options);
+			funcs[i]->draw(text, names);
+			drawn[i] = move(text.buf);
+		}
+		FuncResult &r = out[keys[i]];
+		r.ret = summaries[i].ret;
+		r.errors = funcs[i]->errors;
+		r.text = drawn[i];
+	}
+}
+
+void GlobalTable::call_graph(vector<vector<sym_t>> &callees)
+{
+	/* edges only go to defined functions, each once */
+	callees.assign(funcs.size(), vector<sym_t>());
+	for (sym_t i = 0; i < funcs.size(); ++i)
+	{
+		if (funcs[i] == nullptr)
+			continue;
+		auto &v = callees[i];
+		for (auto b = funcs[i]->blocks.begin(); b != funcs[i]->blocks.end(); ++b)
+		{
+			if (*b == nullptr)
+				continue;
+			const Instr *s = funcs[i]->code.data() + (*b)->first;
+			for (int k = 0; k < (*b)->count; ++k, ++s)
+			{
+				if (s->op != CALL)
+					continue;
+				sym_t to = s->arg1;
+				if (to < funcs.size() && funcs[to] != nullptr)
+					v.push_back(to);
+			}
+		}
+		sort(v.begin(), v.end());
+		v.erase(unique(v.begin(), v.end()), v.end());
+	}
+}
+
+void GlobalTable::order_sccs(const vector<vector<sym_t>> &callees, vector<vector<sym_t>> &sccs)
+{
+	/* iterative tarjan, an scc is emitted after every scc it calls into */
+	int n = funcs.size(), counter = 0;
+	vector<int> index(n, -1), low(n, 0);
+	vector<bool> on(n, false);
+	vector<sym_t> st;
+	vector<pair<sym_t, size_t>> work;
+	for (sym_t root = 0; root < n; ++root)
+	{
+		if (funcs[root] == nullptr || index[root] >= 0)
+			continue;
+		index[root] = low[root] = counter++;
+		st.push_back(root);
+		on[root] = true;
+		work.push_back(make_pair(root, 0));
+		while (!work.empty())
+		{
+			sym_t v = work.back().first;
+			if (work.back().second < callees[v].size())
+			{
+				sym_t w = callees[v][work.back().second++];
+				if (index[w] < 0)
+				{
+					index[w] = low[w] = counter++;
+					st.push_back(w);
+					on[w] = true;
+					work.push_back(make_pair(w, 0));
+				}
+				else if (on[w])
+					low[v] = min(low[v], index[w]);
+				continue;
+			}
+			work.pop_back();
+			if (!work.empty())
+				low[work.back().first] = min(low[work.back().first], low[v]);
+			if (low[v] != index[v])
+				continue;
+			sccs.push_back(vector<sym_t>());
+			sym_t w;
+			do
+			{
+				w = st.back();
+				st.pop_back();
+				on[w] = false;
+				sccs.back().push_back(w);
+			} while (w != v);
+			sort(sccs.back().begin(), sccs.back().end());
+		}
+	}
+}
+
+void GlobalTable::solve_scc(const vector<sym_t> &members, bool recursive, CallResolver &calls)
+{
+	if (recursive)
+	{
+		/*
+		 * calls inside the scc read the summaries of its members, which
+		 * start from never returning and grow until no return range moves.
+		 * after ret_widen_delay rounds a growing range is widened
+		 */
+		const int ret_widen_delay = 2;
+		for (auto m = members.begin(); m != members.end(); ++m)
+		{
+			summaries[*m].defined = true;
+			summaries[*m].args = funcs[*m]->args.size();
+			summaries[*m].ret = VarTable();
+		}
+		for (int round = 0; ; ++round)
+		{
+			bool changed = false;
+			for (auto m = members.begin(); m != members.end(); ++m)
+			{
+				FuncTable *f = funcs[*m];
+				iterations += solve_with(engine, f, &calls, budget);
+				VarTable now = summaries[*m].ret;
+				VarTable got = f->ret != nullptr ? *f->ret : VarTable();
+				if (round < ret_widen_delay)
+					now.join(got);
+				else
+					now.widen(got);
+				if (!now.same(summaries[*m].ret))
+				{
+					summaries[*m].ret = now;
+					changed = true;
+				}
+			}
+			if (!changed)
+				break;
+		}
+	}
+	else
+		iterations += solve_with(engine, funcs[members[0]], &calls, budget);
+	for (auto m = members.begin(); m != members.end(); ++m)
+	{
+		if (!recursive)
+			summarize(funcs[*m]);
+		calls.settled[*m] = 1;
+	}
+}
+
+VarTable CallResolver::call(sym_t callee, const vector<VarTable> &args)
+{
+	static thread_local int depth = 0;
+	static thread_local int left = 0;		// solves the outermost call may still spend
+	static thread_local bool cut = false;	// a call below was answered by its summary
+	static thread_local map<pair<sym_t, vector<double>>, VarTable> inexact;	// under this outermost call
+	VarTable full(NO_SYM, FLOAT);
+	if (callee >= table.summaries.size())
+		return full;
+	const FuncSummary &s = table.summaries[callee];
+	if (callee >= settled.size() || !settled[callee])
+		return s.defined ? s.ret : full;
+	FuncTable *f = table.funcs[callee];
+	if (f == nullptr || args.size() != f->args.size())
+		return s.ret;
+	if (depth >= depth_limit)
+	{
+		cut = true;
+		return s.ret;
+	}
+	/* calls with the declared ranges are what the summary already says */
+	bool general = true;
+	vector<double> key;
+	for (int i = 0; i < args.size(); ++i)
+	{
+		if (args[i].empty())
+			return VarTable();
+		general = general && args[i].same(*f->vars[f->args[i]]);
+		key.push_back(args[i].low);
+		key.push_back(args[i].up);
+		key.push_back((args[i].bound[0] == '(') + 2 * (args[i].bound[1] == ')'));
+	}
+	if (general)
+		return s.ret;
+	auto k = make_pair(callee, key);
+	if (depth == 0)
+	{
+		left = solve_limit;
+		cut = false;
+		inexact.clear();
+	}
+	auto near = inexact.find(k);
+	if (near != inexact.end())
+	{
+		cut = true;
+		return near->second;
+	}
+	{
+		lock_guard<mutex> hold(lock);
+		auto found = memo.find(k);
+		if (found != memo.end() && found->second.second <= left)
+		{
+			left -= found->second.second;
+			return found->second.first;
+		}
+	}
+	if (left <= 0)
+	{
+		cut = true;
+		return s.ret;
+	}
+	/* solved on the side, in an arena of its own, the callee is only read */
+	VarTable res;
+	int before = left--;
+	bool outer = cut;
+	cut = false;
+	depth++;
+	/* an answer the budget cut short is not kept, it depends on the clock */
+	if (table.engine == EN_SPARSE)
+	{
+		SparseSolver solver(f, this, true);
+		solver.budget = table.budget;
+		res = solver.solve(args);
+		cut = cut || solver.approximate;
+	}
+	else
+	{
+		Arena arena;
+		EnvPool pool(arena);
+		RangeSolver solver(f, pool, this);
+		solver.budget = table.budget;
+		res = solver.solve(args);
+		cut = cut || solver.approximate;
+	}
+	depth--;
+	bool exact = !cut;
+	cut = outer || cut;
+	if (!exact)
+	{
+		inexact[k] = res;
+		return res;
+	}
+	lock_guard<mutex> hold(lock);
+	/* a full table starts over rather than tracking what is least used */
+	if (memo.size() >= limit)
+		memo.clear();
+	memo[k] = make_pair(res, before - left);
+	return res;
+}
+
+void GlobalTable::collect(vector<myError> &out)
+{
+	/* diagnostics come out in definition order whatever the schedule was */
+	out.insert(out.end(), errors.begin(), errors.end());
+	for (auto i = funcs.begin(); i != funcs.end(); ++i)
+	{
+		if (*i == nullptr)
+			continue;
+		out.insert(out.end(), (*i)->errors.begin(), (*i)->errors.end());
+	}
+}
+
+void GlobalTable::draw(const string &path)
+{
+	ofstream file(path, ios::binary);
+	Emitter drawer(options, &file);
+	drawer.header();
+	vector<sym_t> order;
+	for (sym_t i = 0; i < funcs.size(); ++i)
+		if (funcs[i] != nullptr)
+			order.push_back(i);
+	sort(order.begin(), order.end(), [this](sym_t a, sym_t b) { return names.names[a] < names.names[b]; });
+	for (auto i = order.begin(); i != order.end(); i++)
+	{
+		if (*i < drawn.size() && !drawn[*i].empty())
+			drawer << drawn[*i];
+		else
+			funcs[*i]->draw(drawer, names);
+		drawer.done();
+	}
+}
+
+/*
+ * each function solved once per scenario, the scenarios of a function in
+ * lanes of one LaneSolver. callees are solved for the ranges each call
+ * passes, as in the first run. text gives per scenario its parameters, the
+ * return and what each variable holds anywhere in the function; json a
+ * line per function and scenario; binary the records below
+ */
+void GlobalTable::draw_scenarios(const string &path, const vector<Scenario> &scenarios, int threads)
+{
+	const int lane_width = 64;		// scenarios solved together
+	CallResolver calls(*this);
+	calls.settled.assign(funcs.size(), 1);
+	vector<int> order;
+	for (sym_t i = 0; i < funcs.size(); ++i)
+		if (funcs[i] != nullptr && options.keeps_func(funcs[i]->func_name))
+			order.push_back(i);
+	sort(order.begin(), order.end(), [this](sym_t a, sym_t b) { return names.names[a] < names.names[b]; });
+	vector<string> text(funcs.size());
+	WorkPool pool(threads);
+	pool.run(order, [this, &scenarios, &calls, &text, lane_width](int id) {
+		FuncTable *f = funcs[id];
+		Emitter e(options);
+		vector<sym_t> shown;
+		for (sym_t i = 0; i < f->vars.size(); ++i)
+			if (f->vars[i] != nullptr && options.keeps_var(f->var_names.names[i]))
+				shown.push_back(i);
+		sort(shown.begin(), shown.end(), [f](sym_t a, sym_t b) { return f->var_names.names[a] < f->var_names.names[b]; });
+		if (options.format == FMT_TEXT)
+			e << "**********************************\nfunction: " << f->func_name << "\n";
+		for (int first = 0; first < scenarios.size(); first += lane_width)
+		{
+			int n = min(lane_width, (int)scenarios.size() - first);
+			vector<vector<VarTable>> args(n);
+			for (int l = 0; l < n; ++l)
+				for (int i = 0; i < f->args.size(); ++i)
+				{
+					VarTable v = *f->vars[f->args[i]];
+					for (auto p = scenarios[first + l].begin(); p != scenarios[first + l].end(); ++p)
+						if (p->first == f->var_names.names[f->args[i]])
+							v.set(p->second.low, p->second.up, p->second.bound[0], p->second.bound[1]);
+					args[l].push_back(v);
+				}
+			LaneSolver solver(f, &calls, n);
+			solver.solve(args);
+			for (int l = 0; l < n; ++l)
+			{
+				VarTable bottom, *ret = solver.returned[l] ? &solver.ret[l] : nullptr;
+				vector<VarTable> held;
+				for (auto i = shown.begin(); i != shown.end(); ++i)
+					held.push_back(solver.hull(*i, l));
+				if (options.format == FMT_BINARY)
+				{
+					e.name(f->func_name);
+					e.raw((uint32_t)(first + l));
+					uint32_t params = 0;
+					for (int i = 0; i < f->args.size(); ++i)
+						params += options.keeps_var(f->var_names.names[f->args[i]]);
+					e.raw(params);
+					for (int i = 0; i < f->args.size(); ++i)
+						if (options.keeps_var(f->var_names.names[f->args[i]]))
+						{
+							e.name(f->var_names.names[f->args[i]]);
+							args[l][i].emit(e);
+						}
+					e.raw((uint8_t)(ret != nullptr));
+					(ret != nullptr ? *ret : bottom).emit(e);
+					e.raw((uint32_t)shown.size());
+					for (int i = 0; i < shown.size(); ++i)
+					{
+						e.name(f->var_names.names[shown[i]]);
+						held[i].emit(e);
+					}
+					continue;
+				}
+				if (options.format == FMT_JSON)
+				{
+					e << "{\"function\": ";
+					json_string(e, f->func_name);
+					e << ", \"scenario\": " << first + l << ", \"parameters\": {";
+					bool any = false;
+					for (int i = 0; i < f->args.size(); ++i)
+						if (options.keeps_var(f->var_names.names[f->args[i]]))
+						{
+							e << (any ? ", " : "");
+							json_string(e, f->var_names.names[f->args[i]]);
+							e << ": ";
+							args[l][i].emit(e);
+							any = true;
+						}
+					e << "}, \"return\": ";
+					if (ret != nullptr)
+						ret->emit(e);
+					else
+						e << "null";
+					e << ", \"variables\": {";
+					for (int i = 0; i < shown.size(); ++i)
+					{
+						e << (i ? ", " : "");
+						json_string(e, f->var_names.names[shown[i]]);
+						e << ": ";
+						held[i].emit(e);
+					}
+					e << "}}\n";
+					continue;
+				}
+				e << "----------------\nscenario " << first + l << "\nparameters: ( ";
+				for (int i = 0; i < f->args.size(); ++i)
+					if (options.keeps_var(f->var_names.names[f->args[i]]))
+						args[l][i].draw(e, f->var_names.names[f->args[i]]);
+				e << ")\nreturn: ( ";
+				if (ret != nullptr)
+					ret->draw(e, "return");
+				e << ")\nvariables: ( ";
+				for (int i = 0; i < shown.size(); ++i)
+					held[i].draw(e, f->var_names.names[shown[i]]);
+				e << ")\n";
+			}
+		}
+		if (options.format == FMT_TEXT)
+			e << "\n\n";
+		text[id] = move(e.buf);
+	});
+	ofstream file(path, ios::binary);
+	Emitter drawer(options, &file);
+	drawer.header(SCENARIO_VERSION);
+	for (auto i = order.begin(); i != order.end(); i++)
+	{
+		drawer << text[*i];
+		drawer.done();
+	}
+}
+
+/*
+ * ranges on demand, without solving the whole input. the first query of a
+ * function solves the sccs it calls into, callees first, so its calls
+ * answer as in a full run; calls back into its own scc read as unknown.
+ * the function itself is only built into its sparse graph, and a query
+ * solves just the definitions, guards and phis its variable depends on,
+ * which stay solved for the queries after. blocks are left out as far as
+ * constants decide their guards; ranges do not drop further blocks as in a
+ * full solve, so an answer can be wider than what a full run draws
+ */
+VarTable GlobalTable::query(sym_t func, sym_t block, sym_t var)
+{
+	if (!answering)
+	{
+		answering.reset(new CallResolver(*this));
+		answering->settled.assign(funcs.size(), 0);
+		asked.resize(funcs.size());
+		call_graph(asked_callees);
+		order_sccs(asked_callees, asked_sccs);
+		asked_scc_of.assign(funcs.size(), -1);
+		for (int c = 0; c < asked_sccs.size(); ++c)
+			for (auto m = asked_sccs[c].begin(); m != asked_sccs[c].end(); ++m)
+				asked_scc_of[*m] = c;
+	}
+	if (!asked[func])
+	{
+		settle_callees(func);
+		asked[func].reset(new SparseSolver(funcs[func], answering.get()));
+		asked[func]->open();
+	}
+	SparseSolver &solver = *asked[func];
+	int before = solver.iterations;
+	VarTable res = solver.query(block, var);
+	iterations += solver.iterations - before;
+	return res;
+}
+
+void GlobalTable::settle_callees(sym_t func)
+{
+	/* the sccs reachable below func's own, solved in the order order_sccs gives */
+	int own = asked_scc_of[func];
+	vector<bool> reach(asked_sccs.size(), false);
+	vector<sym_t> work(1, func);
+	while (!work.empty())
+	{
+		sym_t f = work.back();
+		work.pop_back();
+		for (auto to = asked_callees[f].begin(); to != asked_callees[f].end(); ++to)
+		{
+			int c = asked_scc_of[*to];
+			if (c == own || reach[c])
+				continue;
+			reach[c] = true;
+			work.insert(work.end(), asked_sccs[c].begin(), asked_sccs[c].end());
+		}
+	}
+	for (int c = 0; c < asked_sccs.size(); ++c)
+	{
+		if (!reach[c] || answering->settled[asked_sccs[c][0]])
+			continue;
+		bool recursive = asked_sccs[c].size() > 1;
+		for (auto m = asked_sccs[c].begin(); m != asked_sccs[c].end(); ++m)
+			for (auto to = asked_callees[*m].begin(); to != asked_callees[*m].end(); ++to)
+				recursive = recursive || *to == *m;
+		solve_scc(asked_sccs[c], recursive, *answering);
+	}
+}
+
+/* the ids q names, or why it names nothing known */
+string GlobalTable::resolve(const Query &q, sym_t &func, sym_t &block, sym_t &var)
+{
+	func = names.find(q.func);
+	FuncTable *f = func != NO_SYM ? funcs[func] : nullptr;
+	string what = "query " + q.func + ":" + q.block + ":" + q.var;
+	if (f == nullptr)
+		return what + " names no function defined";
+	block = f->block_names.find(q.block);
+	var = f->var_names.find(q.var);
+	if (block == NO_SYM || f->blocks[block] == nullptr)
+		return what + " names no block of " + q.func;
+	if (var == NO_SYM || f->vars[var] == nullptr)
+		return what + " names no variable of " + q.func;
+	return string();
+}
+
+/* answers in the order asked; a query naming nothing known is reported and answered with id NO_SYM */
+void GlobalTable::answer(const vector<Query> &queries, vector<VarTable> &out)
+{
+	out.clear();
+	for (auto q = queries.begin(); q != queries.end(); ++q)
+	{
+		sym_t f, b, v;
+		string bad = resolve(*q, f, b, v);
+		if (bad.empty())
+			out.push_back(query(f, b, v));
+		else
+		{
+			errors.push_back(myError(ANALYSIS_ERROR, bad, f != NO_SYM && funcs[f] != nullptr ? funcs[f]->line : 0));
+			out.push_back(VarTable());
+		}
+	}
+}
+
+/* a line or record per answered query, in the order asked */
+void GlobalTable::draw_queries(const string &path, const vector<Query> &queries, const vector<VarTable> &answers)
+{
+	ofstream file(path, ios::binary);
+	Emitter e(options, &file);
+	e.header(QUERY_VERSION);
+	for (int i = 0; i < queries.size(); ++i)
+	{
+		const Query &q = queries[i];
+		if (answers[i].id == NO_SYM)
+			continue;
+		if (options.format == FMT_BINARY)
+		{
+			e.name(q.func);
+			e.name(q.block);
+			e.name(q.var);
+			answers[i].emit(e);
+		}
+		else if (options.format == FMT_JSON)
+		{
+			e << "{\"function\": ";
+			json_string(e, q.func);
+			e << ", \"block\": ";
+			json_string(e, q.block);
+			e << ", \"variable\": ";
+			json_string(e, q.var);
+			e << ", \"range\": ";
+			answers[i].emit(e);
+			e << "}\n";
+		}
+		else
+		{
+			e << q.func << ", " << q.block << ": ( ";
+			answers[i].draw(e, q.var);
+			e << ")\n";
+		}
+		e.done();
+	}
+}
+
+/* the whole input is mapped read-only, tokens are views into it */
+class MappedFile
+{
+#ifdef _WIN32
+	vector<char> copy;
+#else
+	bool mapped;
+#endif
+public:
+	const char *data;
+	size_t size;
+	MappedFile() : data(""), size(0)
+	{
+#ifndef _WIN32
+		mapped = false;
+#endif
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile()
+	{
+		close();
+	}
+	bool open(const string &filename);
+	void close();
+	void drop(size_t upto) const;
+};
+
+bool MappedFile::open(const string &filename)
+{
+	close();
+#ifdef _WIN32
+	ifstream in(filename.c_str(), ios::in | ios::binary);
+	if (!in)
+		return false;
+	copy.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	data = copy.empty() ? "" : copy.data();
+	size = copy.size();
+	return true;
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) < 0)
+	{
+		::close(fd);
+		return false;
+	}
+	if (st.st_size > 0)
+	{
+		void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (m == MAP_FAILED)
+		{
+			::close(fd);
+			return false;
+		}
+		madvise(m, st.st_size, MADV_SEQUENTIAL);
+		data = (const char*)m;
+		size = st.st_size;
+		mapped = true;
+	}
+	::close(fd);
+	return true;
+#endif
+}
+
+void MappedFile::drop(size_t upto) const
+{
+	/* nothing before upto is read again, let the kernel have those pages back */
+#ifndef _WIN32
+	static const size_t page = sysconf(_SC_PAGESIZE);
+	upto -= upto % page;
+	if (mapped && upto > 0)
+		madvise((void*)data, min(upto, size), MADV_DONTNEED);
+#endif
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	copy.clear();
+#else
+	if (mapped)
+		munmap((void*)data, size);
+	mapped = false;
+#endif
+	data = "";
+	size = 0;
+}
+
+/* character classes of the ssa dialect, one table lookup per character */
+enum CHAR_CLASS {CC_ALPHA = 1, CC_DIGIT = 2, CC_SPACE = 4, CC_ID = 8, CC_NUMBER = 16, CC_SIGN = 32};
+
+class CharClassTable
+{
+public:
+	unsigned char t[256];
+	CharClassTable()
+	{
+		memset(t, 0, sizeof(t));
+		for (int c = 'a'; c <= 'z'; ++c)
+			t[c] |= CC_ALPHA | CC_ID;
+		for (int c = 'A'; c <= 'Z'; ++c)
+			t[c] |= CC_ALPHA | CC_ID;
+		for (int c = '0'; c <= '9'; ++c)
+			t[c] |= CC_DIGIT | CC_ID | CC_NUMBER;
+		t['_'] |= CC_ALPHA | CC_ID;
+		t['.'] |= CC_ID | CC_NUMBER;
+		t['('] |= CC_ID;
+		t[')'] |= CC_ID;
+		t['-'] |= CC_SIGN;
+		t['+'] |= CC_SIGN;
+		t[' '] |= CC_SPACE;
+		t['\t'] |= CC_SPACE;
+		t['\r'] |= CC_SPACE;
+		t['\n'] |= CC_SPACE;
+	}
+};
+
+const CharClassTable char_class;
+
+inline bool char_is(char c, int cls)
+{
+	return (char_class.t[(unsigned char)c] & cls) != 0;
+}
+
+class SSAHandler
+{
+	const MappedFile &src;
+	size_t pos;			// start of the next line in src
+	const char *buffer;	// current line, not terminated
+	int len;
+	int p;
+	char ch;
+	bool eof;
+	FuncTable *cur_func;
+	BlockTable *cur_block;
+	unordered_map<string_view, sym_t> spellings;	// operands of cur_func as written, e.g. "k_2"
+	enum STATES {END, GLOBAL, FUNCTION_HEAD, PARAMETER, FUNCTION_BODY};
+	GlobalTable &table;
+	stack<STATES> states;
+	int line;
+
+	/* the character after the current one, '\0' past the end of the line */
+	char next()
+	{
+		return p < len ? buffer[p++] : (p++, '\0');
+	}
+	int nextline();
+	void strip();
+	void passto(char end);
+	string_view cutid();
+	string_view cutnumber();
+	string_view cut();
+	string_view cutto(char end);
+	sym_t pruneid(string_view a);
+	sym_t operand(string_view a);
+	void emit(const Instr &s);
+	void parse_parameter();
+	void parse_function_head();
+	void parse_statement();
+	void parse_goto(string_view &a);
+	void report(ERROR_TYPE code, string msg)
+	{
+		errors.push_back(myError(code, msg, line));
+	}
+
+public:
+	vector<myError> errors;		// in the order they were found
+	SSAHandler(const MappedFile &_src, GlobalTable &_table) : src(_src), table(_table)
+	{
+		pos = 0;
+		buffer = "";
+		len = 0;
+		p = 0;
+		eof = false;
+		states.push(END);
+		cur_func = nullptr;
+		cur_block = nullptr;
+		line = 0;
+	}
+	void parse();
+};
+
+string_view SSAHandler::cutid()
+{
+	int start = p - 1;
+	int count = 0;
+	while (char_is(ch, CC_ID))
+	{
+		if (ch == '(')
+			count++;
+		if (ch == ')')
+		{
+			if (count > 0)
+				count--;
+			else
+				break;
+		}
+		ch = next();
+	}
+	return string_view(buffer + start, p - 1 - start);
+}
+
+string_view SSAHandler::cutnumber()
+{
+	int start = p - 1;
+	ch = next();
+	while (char_is(ch, CC_NUMBER))
+		ch = next();
+	if (ch == 'e' || ch == 'E')
+	{
+		ch = next();
+		if (char_is(ch, CC_SIGN))
+			ch = next();
+		while (char_is(ch, CC_DIGIT))
+			ch = next();
+	}
+	return string_view(buffer + start, p - 1 - start);
+}
+
+string_view SSAHandler::cut()
+{
+	if (char_is(ch, CC_SIGN | CC_DIGIT))
+	{
+		/* again a number */
+		return cutnumber();
+	}
+	else if (char_is(ch, CC_ALPHA))
+	{
+		/* this should be a variable */
+		return cutid();
+	}
+	return string_view();
+}
+
+string_view SSAHandler::cutto(char end)
+{
+	/* text up to end on this line, ch is left on end */
+	int start = p - 1;
+	while (ch != end && ch != '\0')
+		ch = next();
+	return string_view(buffer + start, p - 1 - start);
+}
+
+sym_t SSAHandler::pruneid(string_view a)
+{
+	/* each ssa spelling is resolved to its variable only once */
+	auto found = spellings.find(a);
+	if (found != spellings.end())
+		return found->second;
+	sym_t id = cur_func->var_names.find(a);
+	if (id == NO_SYM || cur_func->vars[id] == nullptr)
+	{
+		size_t p_ = string_view::npos;
+		/* TODO: what if the subscript useful? */
+		if ((p_ = a.find_last_of('_')) != string_view::npos && p_ != 0)
+			id = cur_func->var(a.substr(0, p_));
+		else
+			id = cur_func->var(a);
+	}
+	spellings[a] = id;
+	return id;
+}
+
+sym_t SSAHandler::operand(string_view a)
+{
+	if (a.empty())
+		return NO_SYM;
+	if (is_number(a))
+		return cur_func->constant(a);
+	return pruneid(a);
+}
+
+void SSAHandler::emit(const Instr &s)
+{
+	if (cur_block == nullptr)
+	{
+		report(SYNTEXT_ERROR, string("statement outside of any block"));
+		return;
+	}
+	cur_func->append(cur_block, s);
+	TRACE(TR_STAT, EV_STATEMENT, line, op_type[s.op], 0, cur_block->count - 1);
+}
+
+int SSAHandler::nextline()
+{
+	Stopwatch w(table.timer(PH_LEX));
+	if (pos >= src.size)
+	{
+		eof = true;
+		return -1;
+	}
+	buffer = src.data + pos;
+	const char *nl = (const char*)memchr(buffer, '\n', src.size - pos);
+	len = nl ? (int)(nl - buffer) : (int)(src.size - pos);
+	pos += len + 1;
+	p = 0;
+	line++;
+	ch = next();
+	return 0;
+}
+
+void SSAHandler::strip()
+{
+	if (ch == '\0')
+	{
+		if (nextline() < 0)
+		{
+			report(SYNTEXT_ERROR, string("unexpected end of file"));
+			return;
+		}
+	}
+	while (char_is(ch, CC_SPACE))
+	{
+		ch = next();
+		if (ch == '\0')
+		{
+			if (nextline() < 0)
+			{
+				report(SYNTEXT_ERROR, string("unexpected end of file"));
+				return;
+			}
+		}
+	}
+}
+
+void SSAHandler::passto(char end)
+{
+	while (ch != end)
+	{
+		ch = next();
+		if (ch == '\0')
+		{
+			if (nextline() < 0)
+			{
+				string msg("miss ");
+				msg.push_back(end);
+				report(SYNTEXT_ERROR, msg);
+				return;
+			}
+		}
+	}
+}
+
+void SSAHandler::parse_parameter()
+{
+	while (ch != ')')
+	{
+		string_view stype = cut();
+		strip();
+		string_view sname = cut();
+		strip();
+		if (ch == ',')
+			ch = next();
+		strip();
+
+		DATA_TYPE dtype = INT;
+		if (stype == "float")
+			dtype = FLOAT;
+
+		/* parameters are declared names, they keep their subscripts */
+		VarTable *tmp = cur_func->declare(sname, dtype);
+		cur_func->args.push_back(tmp->id);
+	}
+	return;
+}
+
+void SSAHandler::parse_function_head()
+{
+	int start = p - 1;
+	while (char_is(ch, CC_ALPHA | CC_DIGIT))
+		ch = next();
+	string fname = string(buffer + start, p - 1 - start);
+	/* record function in process */
+	cur_func = table.put(fname);
+	cur_func->line = line;
+	TRACE(TR_FUNC, EV_FUNCTION, line, fname);
+	spellings.clear();
+	while (ch == ' ' || ch == '\t')
+		ch = next();
+	if (ch != '(')
+	{
+		report(SYNTEXT_ERROR, string("[ERROR] no '(' at function head ") + fname);
+		return;
+	}
+	/* in state of handle parameters */
+	states.push(PARAMETER);
+	ch = next();
+	while (ch == ' ' || ch == '\t')
+		ch = next();
+	parse_parameter();
+	while (ch == ' ' || ch == '\t')
+		ch = next();
+	if (ch != ')')
+	{
+		report(SYNTEXT_ERROR, string("[ERROR] no ')' at function head ").append(fname));
+		return;
+	}
+	/* out state of handle parameter */
+	states.pop();
+	ch = next();
+	return;
+}
+
+void SSAHandler::parse_goto(string_view &a)
+{
+	if (ch == '<')
+	{
+		ch = next();	// this is '<'
+		a = cutto('>');
+		ch = next();	// this is '>'
+		strip();
+		if (ch == '(')
+		{
+			ch = next();
+			strip();
+			if (ch == '<')
+			{
+				ch = next();	// this is '<'
+				a = cutto('>');
+				ch = next();	// this is '>'
+				strip();
+			}
+			ch = next();	//	this is ')'
+		}
+		strip();
+		ch = next();	// this is ';'
+		strip();
+	}
+	return;
+}
+
+void SSAHandler::parse_statement()
+{
+	if (char_is(ch, CC_SIGN | CC_DIGIT))
+	{
+		/* this statement is not an assign, ignore it */
+		passto(';');
+		return;
+	}
+	/* if statement begins with id */
+	string_view tmp = cut();
+	/* declaration of variables */
+	if (tmp == "int" || tmp == "float")
+	{
+		strip();
+		string_view id = cutid();
+		if(tmp == "int")
+			cur_func->declare(id, INT);
+		else 
+			cur_func->declare(id, FLOAT);
+		return;
+	}
+	else if (tmp == "if")
+	{
+		strip();
+		ch = next();	//this is '('
+		strip();
+		string_view left, right;
+		OP_TYPE type, another_type;
+		left = cut();
+		strip();
+		if (ch == '<')
+		{
+			ch = next();
+			if (ch == '=')
+			{
+				type = GOTO_LE;
+				another_type = GOTO_G;
+				ch = next();
+			}
+			else
+			{
+				type = GOTO_L;
+				another_type = GOTO_GE;
+			}
+		}
+		else if (ch == '=')
+		{
+			ch = next();
+			if (ch == '=')
+			{
+				type = GOTO_EQ;
+				another_type = GOTO_NE;
+				ch = next();
+			}
+		}
+		else if (ch == '!')
+		{
+			ch = next();
+			if (ch == '=')
+			{
+				type = GOTO_NE;
+				another_type = GOTO_EQ;
+				ch = next();
+			}
+		}
+		else if (ch == '>')
+		{
+			ch = next();
+			if (ch == '=')
+			{
+				type = GOTO_GE;
+				another_type = GOTO_L;
+				ch = next();
+			}
+			else
+			{
+				type = GOTO_G;
+				another_type = GOTO_LE;
+			}
+		}
+		strip();
+		right = cut();
+		strip();
+		ch = next();	//this is ')'
+		strip();
+		string_view to_true, to_false;
+		cut();
+		strip();
+		parse_goto(to_true);
+		strip();
+		cut();
+		strip();
+		cut();
+		strip();
+		parse_goto(to_false);
+		strip();
+		if (cur_block == nullptr)
+		{
+			report(SYNTEXT_ERROR, string("if outside of any block"));
+			return;
+		}
+		/* add another two blocks */
+		string &cur_block_name = cur_func->block_names.names[cur_block->id];
+		string left_name = cur_block_name + string("_true"), right_name = cur_block_name + string("_false");
+		BlockTable* left_blk = cur_func->add_block(cur_func->block(left_name));
+		BlockTable* right_blk = cur_func->add_block(cur_func->block(right_name));
+		cur_block->next.push_back(left_blk->id);
+		cur_block->next.push_back(right_blk->id);
+		Instr guard;
+		guard.op = type;
+		guard.arg1 = operand(left);
+		guard.arg2 = operand(right);
+		cur_func->append(left_blk, guard);
+		guard.op = another_type;
+		cur_func->append(right_blk, guard);
+		left_blk->next.push_back(cur_func->block(to_true));
+		right_blk->next.push_back(cur_func->block(to_false));
+		cur_block = nullptr;		// means no current block
+		return;
+	}
+	else if (tmp == "goto")
+	{
+		strip();
+		string_view to_where;
+		parse_goto(to_where);
+		if (cur_block != nullptr)
+			cur_block->next.push_back(cur_func->block(to_where));
+		cur_block = nullptr;	// means no current block
+		return;
+	}
+	else if (tmp == "return")
+	{
+		strip();
+		string_view result = cut();
+		strip();
+		Instr cur_stat;
+		cur_stat.op = RETURN;
+		cur_stat.result = operand(result);
+		emit(cur_stat);
+		return;
+	}
+	else
+	{
+		strip();
+		if (ch != '=')
+		{
+			/* useless statement without assign */
+			passto(';');
+			return;
+		}
+		/* next we only consider about assign */
+		OP_TYPE type = ASSIGN;
+		Instr cur_stat;
+		cur_stat.result = operand(tmp);
+		ch = next();
+		strip();
+		if (ch == '(')
+		{
+			/* this is cast statement */
+			ch = next();
+			strip();
+			string_view cur_type = cut();
+			strip();
+			type = FLOAT_CAST;
+			if (cur_type == "int")
+				type = INT_CAST;
+			ch = next();
+			strip();
+			string_view arg1 = cut();
+			strip();
+			cur_stat.op = type;
+			cur_stat.arg1 = operand(arg1);
+			emit(cur_stat);
+			return;
+		}
+		else
+		{
+			string_view arg1 = cut();
+			strip();
+			if (ch == ';')
+			{
+				cur_stat.op = type;
+				cur_stat.arg1 = operand(arg1);
+				emit(cur_stat);
+				return;
+			}
+			else if (ch == '+' || ch == '-' || ch == '*' || ch == '/')
+			{
+				if (ch == '+')
+					type = ADD;
+				else if (ch == '-')
+					type = SUB;
+				else if (ch == '*')
+					type = MUL;
+				else if (ch == '/')
+					type = DIV;
+				ch = next();
+				strip();
+				string_view arg2 = cut();
+				strip();
+				cur_stat.op = type;
+				cur_stat.arg1 = operand(arg1);
+				cur_stat.arg2 = operand(arg2);
+				emit(cur_stat);
+				return;
+			}
+			else if (ch == '(')
+			{
+				/* call of function */
+				cur_stat.op = CALL;
+				/* callee names are not ssa names, keep them whole */
+				cur_stat.arg1 = table.intern(arg1);
+				cur_stat.first = cur_func->operands.size();
+				ch = next();
+				strip();
+				while(ch != ')')
+				{ 
+					string_view arg = cut();
+					strip();
+					if (ch == ',')
+					{
+						ch = next();
+						strip();
+					}
+					cur_func->operands.push_back(operand(arg));
+				}
+				cur_stat.count = cur_func->operands.size() - cur_stat.first;
+				ch = next();
+				emit(cur_stat);
+				return;
+			}
+		}		
+	}
+}
+
+void SSAHandler::parse()
+{
+	ch = next();
+	states.push(GLOBAL);
+	while (!eof)
 	{
-		char to_where[100];
-		int pt = 0;
-		ch = buffer[p++];	// this is '<'
-		while (ch != '>')
+		if (ch == '\0')
+		{
+			nextline();
+		}
+		else if ((ch == ' ') || (ch == '\t'))
+		{
+			strip();
+		}
+		else if (char_is(ch, CC_ALPHA | CC_DIGIT))
+		{
+			if (states.top() == GLOBAL)
+			{
+				/* this should be head of a function */
+				states.push(FUNCTION_HEAD);
+				parse_function_head();
+				states.pop();
+			}
+			else if (states.top() == FUNCTION_BODY)
+			{
+				/* this should be def or use */
+				parse_statement();
+			}
+		}
+		else if (ch == '{')
 		{
-			to_where[pt++] = ch;
-			ch = buffer[p++];
+			if (states.top() == GLOBAL)
+			{
+				/* this should be body of current function */
+				states.push(FUNCTION_BODY);
+				ch = next();
+			}
 		}
-		to_where[pt] = '\0';
-		a = to_where;
-		ch = buffer[p++];	// this is '>'
-		strip();
-		if (ch == '(')
+		else if (ch == '}')
 		{
-			ch = buffer[p++];
-			strip();
-			if (ch == '<')
+			if (states.top() == FUNCTION_BODY)
 			{
-				ch = buffer[p++];	// this is '<'
-				pt = 0;
-				while (ch != '>')
+				/* this is end of function */
+				states.pop();
+				states.push(GLOBAL);
+				ch = next();
 				{
-					to_where[pt++] = ch;
-					ch = buffer[p++];
+					Stopwatch w(table.timer(PH_WIRE));
+					for (auto i = cur_func->blocks.begin(); i != cur_func->blocks.end(); ++i)
+					{
+						if (*i == nullptr)
+							continue;
+						auto &v = (*i)->next;
+						for (auto j = v.begin(); j != v.end(); j++)
+						{
+							/* a jump to a label never defined is reported, the flow graph leaves it out */
+							if (cur_func->blocks[*j] != nullptr)
+								cur_func->blocks[*j]->pre.push_back((*i)->id);
+							else
+								report(SYNTEXT_ERROR, string("in ") + cur_func->func_name + ", " + cur_func->block_names.names[(*i)->id]
+									+ " jumps to " + cur_func->block_names.names[*j] + " which is never defined");
+						}
+					}
+					cur_func->compact();
+					cur_func->flow.build(cur_func);
 				}
-				to_where[pt] = '\0';
-				a = to_where;
-				ch = buffer[p++];	// this is '>'
-				strip();
+				table.finish(cur_func);
+				if (table.streaming)
+				{
+					spellings.clear();
+					src.drop(pos);
+				}
+				cur_func = nullptr;
+				cur_block = nullptr;
 			}
-			ch = buffer[p++];	//	this is ')'
 		}
-		strip();
-		ch = buffer[p++];	// this is ';'
-		strip();
+		else if (ch == ';')
+		{
+			if (states.top() == GLOBAL)
+			{
+				ch = next();
+				if (ch == ';')
+				{
+					nextline();
+				}
+				else
+				{
+					report(SYNTEXT_ERROR, string("[ERROR] ';' outside function"));
+				}
+			}
+			else
+			{
+				ch = next();
+			}
+		}
+		else if (ch == '#')
+		{
+			nextline();
+		}
+		else if (ch == '<')
+		{
+			/* this is block */
+			ch = next();
+			string_view blockname = cutto('>');
+			ch = next();	// this is '>'
+			ch = next();	// this is ':'
+			sym_t bid = cur_func->block(blockname);
+			if (cur_block != nullptr)
+			{
+				cur_block->next.push_back(bid);
+			}
+			cur_block = cur_func->add_block(bid);
+			TRACE(TR_BLOCK, EV_BLOCK, line, blockname);
+		}
+		else
+		{
+			/* nothing we know starts here, step over it */
+			ch = next();
+		}
 	}
-	return;
 }
 
-void SSAHandler::parse_statement()
+/*
+ * parsed functions can be kept in a cache directory, keyed by a hash of the
+ * input, so an unchanged input skips SSAHandler. a cache file is a header
+ * followed by one record per function. a record is position independent:
+ * fixed size arrays at 8 byte aligned offsets from its start, names as
+ * (offset, length) into its own character block, so it is read straight
+ * out of the mapping. bump CACHE_VERSION whenever the parser, the ir or
+ * what solving finds changes; results below are kept under it too.
+ */
+const uint32_t CACHE_VERSION = 4;
+const uint32_t CACHE_ENDIAN = 0x01020304;
+
+struct CacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint64_t hash;
+	uint64_t input_size;
+	uint64_t n_funcs;
+	uint64_t check;		// content_hash of everything after the header
+};
+
+struct CacheFunc
+{
+	uint32_t size;		// of the whole record, a multiple of 8
+	int32_t line;
+	int32_t entry;
+	uint32_t name;		// string index
+	uint32_t n_args, n_vars, n_blocks, n_consts, n_stats, n_edges, n_operands, n_strs;
+	uint32_t args, vars, blocks, consts, stats, edges, operands, strs;	// offsets
+};
+
+struct CacheStr
+{
+	uint32_t off;
+	uint32_t len;
+};
+
+struct CacheVar
+{
+	uint32_t name;
+	int32_t type;		// -1 when never declared
+};
+
+struct CacheBlock
+{
+	uint32_t name;
+	int32_t defined;
+	uint32_t stat, n_stat;	// into stats
+	uint32_t next, n_next;	// into edges
+	uint32_t pre, n_pre;
+};
+
+struct CacheConst
+{
+	uint32_t name;
+	int32_t type;
+	double value;
+};
+
+struct CacheStat
 {
-	if (ch == '-' || ch == '+' || (ch >= '0' && ch <= '9'))
+	int32_t op;
+	int32_t result;
+	int32_t arg1;		// callee string index for CALL
+	int32_t arg2;
+	uint32_t first, count;	// CALL arguments, into operands
+};
+
+uint64_t content_hash(const char *data, size_t size)
+{
+	/* a word at a time with a final avalanche, fine for keys, not for adversaries */
+	const uint64_t k1 = 0x9e3779b97f4a7c15ULL, k2 = 0xc2b2ae3d27d4eb4fULL;
+	uint64_t h = 0xcbf29ce484222325ULL ^ size;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
 	{
-		/* this statement is not an assign, ignore it */
-		passto(';');
-		return;
+		uint64_t w;
+		memcpy(&w, data + i, 8);
+		h ^= w * k1;
+		h = ((h << 31) | (h >> 33)) * k2;
 	}
-	/* if statement begins with id */
-	string tmp;
-	cut(tmp);
-	/* declaration of variables */
-	if (tmp == "int" || tmp == "float")
+	for (; i < size; ++i)
+		h = (h ^ (unsigned char)data[i]) * k1;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return h;
+}
+
+string cache_path(const string &dir, uint64_t hash)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.ssac", (unsigned long long)hash);
+	return (filesystem::path(dir) / name).string();
+}
+
+/* lays out one function as a cache record */
+class RecordEncoder
+{
+	vector<CacheStr> strs;
+	string chars;
+	uint32_t str(const string &s);
+	template <class T> uint32_t put(const vector<T> &v);
+public:
+	vector<char> rec;
+	void encode(FuncTable *f, const SymbolTable &callees);
+};
+
+uint64_t fingerprint(FuncTable *f, const SymbolTable &callees)
+{
+	/* the record without the line it starts at, moving a function is no change */
+	RecordEncoder e;
+	e.encode(f, callees);
+	((CacheFunc*)e.rec.data())->line = 0;
+	return content_hash(e.rec.data(), e.rec.size());
+}
+
+/* writes records as functions come, to a temporary that replaces path on save */
+class CacheWriter
+{
+	fstream out;
+	string path, tmp;
+	CacheHeader head;
+	RecordEncoder enc;
+	vector<uint64_t> checks;	// one per record, folded on save
+public:
+	bool good;
+	CacheWriter(const string &_path, uint64_t hash, uint64_t input_size);
+	~CacheWriter();
+	void add(FuncTable *f, const SymbolTable &callees);
+	bool save();
+};
+
+CacheWriter::CacheWriter(const string &_path, uint64_t hash, uint64_t input_size) : path(_path)
+{
+	/* jobs with the same input may race to write, each has its own temporary */
+	tmp = path + "." + to_string(std::hash<thread::id>()(this_thread::get_id()) ^ (uintptr_t)this) + ".tmp";
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, "SSARANGE", 8);
+	head.version = CACHE_VERSION;
+	head.endian = CACHE_ENDIAN;
+	head.hash = hash;
+	head.input_size = input_size;
+	out.open(tmp, ios::out | ios::binary | ios::trunc);
+	out.write((const char*)&head, sizeof(head));
+	good = out.good();
+}
+
+CacheWriter::~CacheWriter()
+{
+	if (out.is_open())
 	{
-		strip();
-		string id;
-		cutid(id);
-		if(tmp == "int")
-			table.funcs[cur_func_name]->vars[id] = new VarTable(id, INT);
-		else 
-			table.funcs[cur_func_name]->vars[id] = new VarTable(id, FLOAT);
-		return;
+		out.close();
+		remove(tmp.c_str());
 	}
-	else if (tmp == "if")
+}
+
+uint32_t RecordEncoder::str(const string &s)
+{
+	CacheStr c;
+	c.off = chars.size();
+	c.len = s.size();
+	chars += s;
+	strs.push_back(c);
+	return strs.size() - 1;
+}
+
+template <class T>
+uint32_t RecordEncoder::put(const vector<T> &v)
+{
+	size_t at = (rec.size() + 7) & ~(size_t)7;
+	rec.resize(at + v.size() * sizeof(T));
+	if (!v.empty())
+		memcpy(rec.data() + at, v.data(), v.size() * sizeof(T));
+	return at;
+}
+
+void RecordEncoder::encode(FuncTable *f, const SymbolTable &callees)
+{
+	strs.clear();
+	chars.clear();
+	rec.assign(sizeof(CacheFunc), 0);
+	CacheFunc h;
+	memset(&h, 0, sizeof(h));
+	h.line = f->line;
+	h.entry = f->entry;
+	h.name = str(f->func_name);
+	vector<CacheVar> vars(f->vars.size());
+	for (sym_t i = 0; i < f->vars.size(); ++i)
 	{
-		strip();
-		ch = buffer[p++];	//this is '('
-		strip();
-		string left, right;
-		OP_TYPE type, another_type;
-		cut(left);
-		strip();
-		if (ch == '<')
+		vars[i].name = str(f->var_names.names[i]);
+		vars[i].type = f->vars[i] != nullptr ? f->vars[i]->type : -1;
+	}
+	vector<CacheConst> consts(f->consts.size());
+	for (sym_t k = 0; k < f->consts.size(); ++k)
+	{
+		consts[k].name = str(f->const_names.names[k]);
+		consts[k].type = f->consts[k].type;
+		consts[k].value = f->consts[k].low;
+	}
+	vector<CacheBlock> blocks(f->blocks.size());
+	vector<CacheStat> stats;
+	vector<int32_t> edges, operands;
+	for (sym_t b = 0; b < f->blocks.size(); ++b)
+	{
+		CacheBlock &c = blocks[b];
+		BlockTable *blk = f->blocks[b];
+		memset(&c, 0, sizeof(c));
+		c.name = str(f->block_names.names[b]);
+		if (blk == nullptr)
+			continue;
+		c.defined = 1;
+		c.stat = stats.size();
+		c.n_stat = blk->count;
+		const Instr *i = f->code.data() + blk->first;
+		for (int k = 0; k < blk->count; ++k, ++i)
 		{
-			ch = buffer[p++];
-			if (ch == '=')
+			CacheStat s;
+			memset(&s, 0, sizeof(s));
+			s.op = i->op;
+			s.result = i->result;
+			if (i->op == CALL)
 			{
-				type = GOTO_LE;
-				another_type = GOTO_G;
-				ch = buffer[p++];
+				s.arg1 = str(callees.names[i->arg1]);
+				s.arg2 = NO_SYM;
+				s.first = operands.size();
+				s.count = i->count;
+				operands.insert(operands.end(), f->operands.begin() + i->first, f->operands.begin() + i->first + i->count);
 			}
 			else
 			{
-				type = GOTO_L;
-				another_type = GOTO_GE;
-			}
-		}
-		else if (ch == '=')
-		{
-			ch = buffer[p++];
-			if (ch == '=')
-			{
-				type = GOTO_EQ;
-				another_type = GOTO_NE;
-				ch = buffer[p++];
+				s.arg1 = i->arg1;
+				s.arg2 = i->arg2;
 			}
+			stats.push_back(s);
 		}
-		else if (ch == '!')
+		c.next = edges.size();
+		c.n_next = blk->next.size();
+		edges.insert(edges.end(), blk->next.begin(), blk->next.end());
+		c.pre = edges.size();
+		c.n_pre = blk->pre.size();
+		edges.insert(edges.end(), blk->pre.begin(), blk->pre.end());
+	}
+	vector<int32_t> args(f->args.begin(), f->args.end());
+	h.n_args = args.size();
+	h.args = put(args);
+	h.n_vars = vars.size();
+	h.vars = put(vars);
+	h.n_blocks = blocks.size();
+	h.blocks = put(blocks);
+	h.n_consts = consts.size();
+	h.consts = put(consts);
+	h.n_stats = stats.size();
+	h.stats = put(stats);
+	h.n_edges = edges.size();
+	h.edges = put(edges);
+	h.n_operands = operands.size();
+	h.operands = put(operands);
+	h.n_strs = strs.size();
+	h.strs = put(strs);
+	/* string offsets become relative to the record */
+	size_t base = rec.size();
+	for (uint32_t i = 0; i < h.n_strs; ++i)
+		((CacheStr*)(rec.data() + h.strs))[i].off += base;
+	rec.insert(rec.end(), chars.begin(), chars.end());
+	rec.resize((rec.size() + 7) & ~(size_t)7, 0);
+	h.size = rec.size();
+	memcpy(rec.data(), &h, sizeof(h));
+}
+
+void CacheWriter::add(FuncTable *f, const SymbolTable &callees)
+{
+	if (!good)
+		return;
+	enc.encode(f, callees);
+	out.write(enc.rec.data(), enc.rec.size());
+	checks.push_back(content_hash(enc.rec.data(), enc.rec.size()));
+	head.n_funcs++;
+	good = out.good();
+}
+
+bool CacheWriter::save()
+{
+	if (!good)
+		return false;
+	head.check = content_hash((const char*)checks.data(), checks.size() * sizeof(uint64_t));
+	out.seekp(0);
+	out.write((const char*)&head, sizeof(head));
+	out.close();
+	if (out.fail())
+	{
+		remove(tmp.c_str());
+		return false;
+	}
+	error_code ec;
+	filesystem::rename(tmp, path, ec);
+	if (ec)
+		remove(tmp.c_str());
+	return !ec;
+}
+
+/* a view of one record, checked before anything is built from it */
+class CacheRecord
+{
+	const char *base;
+	const CacheFunc *h;
+	bool fits(uint32_t off, uint32_t n, size_t size) const
+	{
+		return off % 8 == 0 && off <= h->size && n <= (h->size - off) / size;
+	}
+public:
+	CacheRecord(const char *_base) : base(_base), h((const CacheFunc*)_base) {}
+	template <class T> const T* at(uint32_t off) const
+	{
+		return (const T*)(base + off);
+	}
+	string_view str(uint32_t i) const
+	{
+		const CacheStr &s = at<CacheStr>(h->strs)[i];
+		return string_view(base + s.off, s.len);
+	}
+	bool valid() const;
+	FuncTable* build(GlobalTable &table) const;
+};
+
+bool CacheRecord::valid() const
+{
+	if (h->size < sizeof(CacheFunc) || h->size % 8 != 0)
+		return false;
+	if (!fits(h->args, h->n_args, 4) || !fits(h->vars, h->n_vars, sizeof(CacheVar)) || !fits(h->blocks, h->n_blocks, sizeof(CacheBlock))
+		|| !fits(h->consts, h->n_consts, sizeof(CacheConst)) || !fits(h->stats, h->n_stats, sizeof(CacheStat))
+		|| !fits(h->edges, h->n_edges, 4) || !fits(h->operands, h->n_operands, 4) || !fits(h->strs, h->n_strs, sizeof(CacheStr)))
+		return false;
+	for (uint32_t i = 0; i < h->n_strs; ++i)
+	{
+		const CacheStr &s = at<CacheStr>(h->strs)[i];
+		if (s.off > h->size || s.len > h->size - s.off)
+			return false;
+	}
+	auto string_ok = [this](uint32_t i) { return i < h->n_strs; };
+	auto var_ok = [this](int32_t a) { return a >= 0 && a < h->n_vars; };
+	auto operand_ok = [this, &var_ok](int32_t a) {
+		return a == NO_SYM || var_ok(a) || (is_constant(a) && ~a < h->n_consts);
+	};
+	auto range_ok = [](uint32_t first, uint32_t n, uint32_t total) { return first <= total && n <= total - first; };
+	if (!string_ok(h->name) || !(h->entry == NO_SYM || (h->entry >= 0 && h->entry < h->n_blocks)))
+		return false;
+	/* ids are rebuilt by interning in order, so names must not repeat */
+	auto distinct = [this](uint32_t table, uint32_t n, size_t stride) {
+		unordered_set<string_view> seen;
+		for (uint32_t i = 0; i < n; ++i)
 		{
-			ch = buffer[p++];
-			if (ch == '=')
-			{
-				type = GOTO_NE;
-				another_type = GOTO_EQ;
-				ch = buffer[p++];
-			}
+			uint32_t s = *(const uint32_t*)(base + table + i * stride);
+			if (s >= h->n_strs || !seen.insert(str(s)).second)
+				return false;
 		}
-		else if (ch == '>')
+		return true;
+	};
+	if (!distinct(h->vars, h->n_vars, sizeof(CacheVar)) || !distinct(h->blocks, h->n_blocks, sizeof(CacheBlock))
+		|| !distinct(h->consts, h->n_consts, sizeof(CacheConst)))
+		return false;
+	for (uint32_t i = 0; i < h->n_args; ++i)
+		if (!var_ok(at<int32_t>(h->args)[i]))
+			return false;
+	for (uint32_t i = 0; i < h->n_vars; ++i)
+		if (!string_ok(at<CacheVar>(h->vars)[i].name) || at<CacheVar>(h->vars)[i].type < -1 || at<CacheVar>(h->vars)[i].type > FLOAT)
+			return false;
+	for (uint32_t i = 0; i < h->n_consts; ++i)
+		if (!string_ok(at<CacheConst>(h->consts)[i].name) || at<CacheConst>(h->consts)[i].type < INT || at<CacheConst>(h->consts)[i].type > FLOAT)
+			return false;
+	for (uint32_t i = 0; i < h->n_blocks; ++i)
+	{
+		const CacheBlock &b = at<CacheBlock>(h->blocks)[i];
+		if (!string_ok(b.name) || !range_ok(b.stat, b.n_stat, h->n_stats)
+			|| !range_ok(b.next, b.n_next, h->n_edges) || !range_ok(b.pre, b.n_pre, h->n_edges))
+			return false;
+	}
+	for (uint32_t i = 0; i < h->n_edges; ++i)
+		if (at<int32_t>(h->edges)[i] < 0 || at<int32_t>(h->edges)[i] >= h->n_blocks)
+			return false;
+	for (uint32_t i = 0; i < h->n_operands; ++i)
+		if (!operand_ok(at<int32_t>(h->operands)[i]))
+			return false;
+	for (uint32_t i = 0; i < h->n_stats; ++i)
+	{
+		const CacheStat &s = at<CacheStat>(h->stats)[i];
+		if (s.op < ADD || s.op > RETURN || !operand_ok(s.result))
+			return false;
+		if (s.op == CALL ? !string_ok(s.arg1) || !range_ok(s.first, s.count, h->n_operands) : !operand_ok(s.arg1) || !operand_ok(s.arg2))
+			return false;
+	}
+	return true;
+}
+
+FuncTable* CacheRecord::build(GlobalTable &table) const
+{
+	FuncTable *f = table.put(str(h->name));
+	f->line = h->line;
+	for (uint32_t i = 0; i < h->n_vars; ++i)
+	{
+		const CacheVar &v = at<CacheVar>(h->vars)[i];
+		if (v.type < 0)
+			f->var(str(v.name));
+		else
+			f->declare(str(v.name), (DATA_TYPE)v.type);
+	}
+	for (uint32_t k = 0; k < h->n_consts; ++k)
+	{
+		const CacheConst &c = at<CacheConst>(h->consts)[k];
+		f->const_names.intern(str(c.name));
+		f->consts.push_back(VarTable(~(sym_t)k, (DATA_TYPE)c.type, c.value, c.value));
+	}
+	f->args.assign(at<int32_t>(h->args), at<int32_t>(h->args) + h->n_args);
+	for (uint32_t b = 0; b < h->n_blocks; ++b)
+		f->block(str(at<CacheBlock>(h->blocks)[b].name));
+	for (uint32_t b = 0; b < h->n_blocks; ++b)
+	{
+		const CacheBlock &c = at<CacheBlock>(h->blocks)[b];
+		if (!c.defined)
+			continue;
+		BlockTable *blk = f->add_block(b);
+		const CacheStat *s = at<CacheStat>(h->stats) + c.stat;
+		for (uint32_t i = 0; i < c.n_stat; ++i, ++s)
 		{
-			ch = buffer[p++];
-			if (ch == '=')
+			Instr p;
+			p.op = (OP_TYPE)s->op;
+			p.result = s->result;
+			if (s->op == CALL)
 			{
-				type = GOTO_GE;
-				another_type = GOTO_L;
-				ch = buffer[p++];
+				p.arg1 = table.intern(str(s->arg1));
+				p.first = f->operands.size();
+				p.count = s->count;
+				f->operands.insert(f->operands.end(), at<int32_t>(h->operands) + s->first, at<int32_t>(h->operands) + s->first + s->count);
 			}
 			else
 			{
-				type = GOTO_G;
-				another_type = GOTO_LE;
+				p.arg1 = s->arg1;
+				p.arg2 = s->arg2;
 			}
+			f->append(blk, p);
 		}
-		strip();
-		cut(right);
-		strip();
-		ch = buffer[p++];	//this is ')'
-		strip();
-		string cur_tmp;
-		string to_true, to_false;
-		cut(cur_tmp);
-		strip();
-		parse_goto(to_true);
-		strip();
-		cut(cur_tmp);
-		strip();
-		cut(cur_tmp);
-		strip();
-		parse_goto(to_false);
-		strip();
-		/* add another two blocks */
-		string left_name = cur_block_name + string("_true"), right_name = cur_block_name + string("_false");
-		BlockTable* left_blk = table.funcs[cur_func_name]->add_block(left_name);
-		BlockTable* right_blk = table.funcs[cur_func_name]->add_block(right_name);
-		table.funcs[cur_func_name]->blocks[cur_block_name]->next.push_back(left_blk->block_name);
-		table.funcs[cur_func_name]->blocks[cur_block_name]->next.push_back(right_blk->block_name);
-		Exp_stat *left_stat = new Exp_stat();
-		Exp_stat *right_stat = new Exp_stat();
-		left_stat->op = type;
-		right_stat->op = another_type;
-		left_stat->arg1 = right_stat->arg1 = left;
-		left_stat->arg2 = right_stat->arg2 = right;
-		left_blk->statements.push_back(left_stat);
-		right_blk->statements.push_back(right_stat);
-		left_blk->next.push_back(to_true);
-		right_blk->next.push_back(to_false);
-		cur_block_name = "0";		// means no current block
+		blk->next.assign(at<int32_t>(h->edges) + c.next, at<int32_t>(h->edges) + c.next + c.n_next);
+		blk->pre.assign(at<int32_t>(h->edges) + c.pre, at<int32_t>(h->edges) + c.pre + c.n_pre);
+	}
+	f->entry = h->entry;
+	f->flow.build(f);
+	return f;
+}
+
+/* false when file is not a complete cache of this input, table is left untouched then */
+bool load_cache(const MappedFile &file, uint64_t hash, uint64_t input_size, GlobalTable &table)
+{
+	if (file.size < sizeof(CacheHeader))
+		return false;
+	const CacheHeader *head = (const CacheHeader*)file.data;
+	if (memcmp(head->magic, "SSARANGE", 8) != 0 || head->version != CACHE_VERSION || head->endian != CACHE_ENDIAN
+		|| head->hash != hash || head->input_size != input_size)
+		return false;
+	/* check every record first, a bad file must not leave half a table */
+	vector<size_t> starts;
+	vector<uint64_t> checks;
+	size_t at = sizeof(CacheHeader);
+	for (uint64_t i = 0; i < head->n_funcs; ++i)
+	{
+		if (file.size - at < sizeof(CacheFunc))
+			return false;
+		CacheRecord r(file.data + at);
+		uint32_t size = ((const CacheFunc*)(file.data + at))->size;
+		if (size > file.size - at || !r.valid())
+			return false;
+		starts.push_back(at);
+		checks.push_back(content_hash(file.data + at, size));
+		at += size;
+	}
+	if (at != file.size || head->check != content_hash((const char*)checks.data(), checks.size() * sizeof(uint64_t)))
+		return false;
+	for (auto i = starts.begin(); i != starts.end(); ++i)
+		table.finish(CacheRecord(file.data + *i).build(table));
+	return true;
+}
+
+/*
+ * results of an incremental run, one file per input path in the cache
+ * directory. entries are keyed as in GlobalTable::keys, written in one go
+ * and read back whole; a file that does not check out is ignored.
+ */
+struct ResultHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint64_t count;
+	uint64_t check;		// content_hash of the entries
+};
+
+/* results drawn another way, solved by another engine or on another budget are kept apart, they hold the drawn text */
+string result_path(const string &dir, const string &input, const EmitOptions &options, ENGINE engine, const Budget &budget)
+{
+	error_code ec;
+	string full = filesystem::absolute(input, ec).lexically_normal().string();
+	if (engine != EN_DENSE)
+		full += string(1, '\0') + "e" + to_string(engine);
+	if (budget.limited())
+		full += string(1, '\0') + "b" + to_string(budget.iterations) + "," + to_string(budget.ms);
+	if (!options.plain())
+	{
+		vector<string> named(options.funcs.begin(), options.funcs.end());
+		sort(named.begin(), named.end());
+		full += string(1, '\0') + to_string(options.format);
+		for (auto n = named.begin(); n != named.end(); ++n)
+			full += string(1, '\0') + "f" + *n;
+		named.assign(options.vars.begin(), options.vars.end());
+		sort(named.begin(), named.end());
+		for (auto n = named.begin(); n != named.end(); ++n)
+			full += string(1, '\0') + "v" + *n;
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.ssar", (unsigned long long)content_hash(full.data(), full.size()));
+	return (filesystem::path(dir) / name).string();
+}
+
+template <class T> void put_pod(string &out, const T &v)
+{
+	out.append((const char*)&v, sizeof(T));
+}
+
+template <class T> bool get_pod(const string &in, size_t &at, T &v)
+{
+	if (in.size() - at < sizeof(T))
+		return false;
+	memcpy(&v, in.data() + at, sizeof(T));
+	at += sizeof(T);
+	return true;
+}
+
+bool get_text(const string &in, size_t &at, string &s)
+{
+	uint64_t len;
+	if (!get_pod(in, at, len) || in.size() - at < len)
+		return false;
+	s.assign(in, at, len);
+	at += len;
+	return true;
+}
+
+bool save_results(const string &path, const unordered_map<uint64_t, FuncResult> &results)
+{
+	string out;
+	ResultHeader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, "SSARSLT", 8);
+	head.version = CACHE_VERSION;
+	head.endian = CACHE_ENDIAN;
+	head.count = results.size();
+	put_pod(out, head);
+	for (auto i = results.begin(); i != results.end(); ++i)
+	{
+		const FuncResult &r = i->second;
+		put_pod(out, i->first);
+		put_pod(out, (int32_t)r.ret.type);
+		put_pod(out, r.ret.low);
+		put_pod(out, r.ret.up);
+		put_pod(out, r.ret.bound);
+		put_pod(out, (uint64_t)r.errors.size());
+		for (auto e = r.errors.begin(); e != r.errors.end(); ++e)
+		{
+			put_pod(out, (int32_t)e->kind());
+			put_pod(out, (int32_t)e->at());
+			put_pod(out, (uint64_t)e->what().size());
+			out += e->what();
+		}
+		put_pod(out, (uint64_t)r.text.size());
+		out += r.text;
+	}
+	head.check = content_hash(out.data() + sizeof(head), out.size() - sizeof(head));
+	memcpy(&out[0], &head, sizeof(head));
+	string tmp = path + "." + to_string(std::hash<thread::id>()(this_thread::get_id())) + ".tmp";
+	{
+		fstream f(tmp, ios::out | ios::binary | ios::trunc);
+		f.write(out.data(), out.size());
+		if (!f.good())
+		{
+			f.close();
+			remove(tmp.c_str());
+			return false;
+		}
+	}
+	error_code ec;
+	filesystem::rename(tmp, path, ec);
+	if (ec)
+		remove(tmp.c_str());
+	return !ec;
+}
+
+bool load_results(const string &path, unordered_map<uint64_t, FuncResult> &results)
+{
+	ifstream f(path, ios::in | ios::binary);
+	if (!f)
+		return false;
+	string in((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+	size_t at = 0;
+	ResultHeader head;
+	if (!get_pod(in, at, head) || memcmp(head.magic, "SSARSLT", 8) != 0 || head.version != CACHE_VERSION
+		|| head.endian != CACHE_ENDIAN || head.check != content_hash(in.data() + at, in.size() - at))
+		return false;
+	unordered_map<uint64_t, FuncResult> got;
+	for (uint64_t i = 0; i < head.count; ++i)
+	{
+		uint64_t key, n_errors;
+		int32_t type;
+		FuncResult r;
+		if (!get_pod(in, at, key) || !get_pod(in, at, type) || !get_pod(in, at, r.ret.low) || !get_pod(in, at, r.ret.up)
+			|| !get_pod(in, at, r.ret.bound) || !get_pod(in, at, n_errors) || (type != INT && type != FLOAT))
+			return false;
+		r.ret.type = (DATA_TYPE)type;
+		for (uint64_t k = 0; k < n_errors; ++k)
+		{
+			int32_t code, line;
+			string extra;
+			if (!get_pod(in, at, code) || !get_pod(in, at, line) || !get_text(in, at, extra) || code < NOTSSA || code > BUDGET_WARNING)
+				return false;
+			r.errors.push_back(myError((ERROR_TYPE)code, extra, line));
+		}
+		if (!get_text(in, at, r.text))
+			return false;
+		got[key] = move(r);
+	}
+	if (at != in.size())
+		return false;
+	results.swap(got);
+	return true;
+}
+
+/* one input of a batch and what came of it */
+class Job
+{
+public:
+	string input;
+	string output;			// where results are drawn, empty to skip
+	EmitOptions options;
+	ENGINE engine = EN_DENSE;
+	Budget budget;
+	uintmax_t size = 0;
+	bool streaming = false;
+	string cache_dir;		// where parsed inputs are kept, empty for none
+	bool cached = false;	// read back from the cache rather than parsed
+	int functions = 0;
+	int reused = -1;		// functions taken from the last run, -1 when not incremental
+	unique_ptr<Stats> stats;	// kept with --stats
+	const vector<Scenario> *scenarios = nullptr;	// with --scenarios, drawn instead of the ranges
+	const vector<Query> *queries = nullptr;		// with --query, answered instead of solving everything
+	vector<myError> errors;
+	void run(int threads);
+};
+
+void Job::run(int threads)
+{
+	if (input.size() < 4 || input.compare(input.size() - 4, 4, ".ssa") != 0)
+	{
+		errors.push_back(myError(NOTSSA, string("The file given is ") + input, 0));
+		output.clear();
 		return;
 	}
-	else if (tmp == "goto")
+	MappedFile file;
+	if (!file.open(input))
 	{
-		strip();
-		string to_where;
-		parse_goto(to_where);
-		table.funcs[cur_func_name]->blocks[cur_block_name]->next.push_back(to_where);
-		cur_block_name = "0";	// means no current block
+		errors.push_back(myError(NOTSSA, string("can not open ") + input, 0));
+		output.clear();
 		return;
 	}
-	else if (tmp == "return")
+	GlobalTable table;
+	table.stats = stats.get();
+	table.options = options;
+	table.engine = engine;
+	table.budget = budget;
+	ofstream file_out;
+	unique_ptr<Emitter> drawer;
+	if (streaming)
 	{
-		strip();
-		string result;
-		cut(result);
-		strip();
-		Exp_stat *cur_stat = new Exp_stat();
-		cur_stat->op = RETURN;
-		cur_stat->result = result;
-		table.funcs[cur_func_name]->blocks[cur_block_name]->statements.push_back(cur_stat);
-		return;
+		table.streaming = true;
+		if (stats)
+			stats->streamed = true;
+		if (!output.empty())
+		{
+			file_out.open(output, ios::binary);
+			drawer.reset(new Emitter(options, &file_out));
+			drawer->header();
+			table.sink = drawer.get();
+		}
 	}
-	else
+	/* an unchanged input is read back from the cache instead of parsed */
+	unique_ptr<CacheWriter> writer;
+	if (!cache_dir.empty())
 	{
-		strip();
-		if (ch != '=')
+		uint64_t hash = content_hash(file.data, file.size);
+		string path = cache_path(cache_dir, hash);
+		MappedFile kept;
 		{
-			/* useless statement without assign */
-			passto(';');
-			return;
+			Stopwatch w(table.timer(PH_LOAD));
+			cached = kept.open(path) && load_cache(kept, hash, file.size, table);
 		}
-		/* next we only consider about assign */
-		OP_TYPE type = ASSIGN;
-		Exp_stat *cur_stat = new Exp_stat();
-		cur_stat->result = tmp;
-		ch = buffer[p++];
-		strip();
-		if (ch == '(')
+		if (cached && stats)
+			stats->outer = PH_LOAD;
+		if (!cached)
 		{
-			/* this is cast statement */
-			ch = buffer[p++];
-			strip();
-			string cur_type;
-			cut(cur_type);
-			strip();
-			type = FLOAT_CAST;
-			if (cur_type == "int")
-				type = INT_CAST;
-			ch = buffer[p++];
-			strip();
-			string arg1;
-			cut(arg1);
-			strip();
-			cur_stat->op = type;
-			cur_stat->arg1 = arg1;
-			table.funcs[cur_func_name]->blocks[cur_block_name]->statements.push_back(cur_stat);
-			return;
+			writer.reset(new CacheWriter(path, hash, file.size));
+			if (streaming)
+				table.keep = [&writer, &table](FuncTable *f) { writer->add(f, table.names); };
+		}
+	}
+	if (!cached)
+	{
+		SSAHandler h(file, table);
+		{
+			Stopwatch w(table.timer(PH_PARSE));
+			h.parse();
 		}
+		errors = h.errors;
+		if (writer && !streaming)
+			for (auto i = table.funcs.begin(); i != table.funcs.end(); ++i)
+				if (*i != nullptr)
+					writer->add(*i, table.names);
+	}
+	/* without streaming, results are kept per input and reused next time */
+	unordered_map<uint64_t, FuncResult> prior;
+	string results;
+	if (!cache_dir.empty() && !streaming && queries == nullptr)
+	{
+		results = result_path(cache_dir, input, options, engine, budget);
+		load_results(results, prior);
+		table.prior = &prior;
+	}
+	vector<VarTable> answers;
+	{
+		Stopwatch w(table.timer(PH_SOLVE));
+		if (queries != nullptr)
+			table.answer(*queries, answers);
+		else
+			table.analyze(threads);
+	}
+	if (stats && !streaming)
+		for (auto i = table.funcs.begin(); i != table.funcs.end(); ++i)
+			if (*i != nullptr)
+				stats->add(*i);
+	/* what did not parse cleanly is parsed again next time, to report it again */
+	if (writer && errors.empty())
+		writer->save();
+	if (!results.empty())
+	{
+		unordered_map<uint64_t, FuncResult> now;
+		table.remember(now);
+		save_results(results, now);
+		reused = table.reused;
+		functions = now.size();
+	}
+	table.collect(errors);
+	if (!streaming && !output.empty())
+	{
+		Stopwatch w(table.timer(PH_DRAW));
+		if (queries != nullptr)
+			table.draw_queries(output, *queries, answers);
+		else if (scenarios != nullptr)
+			table.draw_scenarios(output, *scenarios, threads);
 		else
+			table.draw(output);
+	}
+}
+
+/* an input is a file, a directory searched for .ssa files, a glob or @list of inputs */
+bool expand_input(const string &arg, vector<string> &inputs)
+{
+	if (arg.size() > 1 && arg[0] == '@')
+	{
+		ifstream list(arg.substr(1));
+		if (!list)
+			return false;
+		bool ok = true;
+		string path;
+		while (getline(list, path))
 		{
-			string arg1;
-			cut(arg1);
-			strip();
-			if (ch == ';')
-			{
-				cur_stat->op = type;
-				cur_stat->arg1 = arg1;
-				table.funcs[cur_func_name]->blocks[cur_block_name]->statements.push_back(cur_stat);
-				return;
-			}
-			else if (ch == '+' || ch == '-' || ch == '*' || ch == '/')
-			{
-				if (ch == '+')
-					type = ADD;
-				else if (ch == '-')
-					type = SUB;
-				else if (ch == '*')
-					type = MUL;
-				else if (ch == '/')
-					type = DIV;
-				ch = buffer[p++];
-				strip();
-				string arg2;
-				cut(arg2);
-				strip();
-				cur_stat->op = type;
-				cur_stat->arg1 = arg1;
-				cur_stat->arg2 = arg2;
-				table.funcs[cur_func_name]->blocks[cur_block_name]->statements.push_back(cur_stat);
-				return;
-			}
-			else if (ch == '(')
-			{
-				/* call of function */
-				Call_stat *cur_stat = new Call_stat();
-				cur_stat->result = tmp;
-				cur_stat->op = CALL;
-				cur_stat->func_name = arg1;
-				ch = buffer[p++];
-				strip();
-				while(ch != ')')
-				{ 
-					string arg;
-					cut(arg);
-					strip();
-					if (ch == ',')
-					{
-						ch = buffer[p++];
-						strip();
-					}
-					cur_stat->args.push_back(arg);
-				}
-				ch = buffer[p++];
-				table.funcs[cur_func_name]->blocks[cur_block_name]->statements.push_back(cur_stat);
-				return;
-			}
-		}		
+			if (!path.empty() && path.back() == '\r')
+				path.pop_back();
+			if (!path.empty())
+				ok = expand_input(path, inputs) && ok;
+		}
+		return ok;
+	}
+#ifndef _WIN32
+	if (arg.find_first_of("*?[") != string::npos)
+	{
+		glob_t found;
+		bool ok = glob(arg.c_str(), 0, nullptr, &found) == 0;
+		for (size_t i = 0; ok && i < found.gl_pathc; ++i)
+			expand_input(found.gl_pathv[i], inputs);
+		globfree(&found);
+		return ok;
+	}
+#endif
+	error_code ec;
+	if (filesystem::is_directory(arg, ec))
+	{
+		vector<string> found;
+		for (filesystem::recursive_directory_iterator i(arg, ec), end; !ec && i != end; i.increment(ec))
+			if (i->is_regular_file(ec) && i->path().extension() == ".ssa")
+				found.push_back(i->path().string());
+		sort(found.begin(), found.end());
+		inputs.insert(inputs.end(), found.begin(), found.end());
+		return !ec;
 	}
+	inputs.push_back(arg);
+	return true;
 }
 
-void SSAHandler::parse(bool draw)
+/* results of a.ssa go to a.range (or .jsonl, .rbin), beside it or in dir when one is given */
+string output_for(const string &input, const string &dir, const string &ext, set<string> &taken)
 {
-	cout << "start parsing..." << endl;
-	ch = buffer[p++];
-	states.push(GLOBAL);
-	while (!file.eof())
+	filesystem::path in(input);
+	if (dir.empty())
+		return in.replace_extension(ext).string();
+	string stem = in.stem().string();
+	string out = (filesystem::path(dir) / (stem + ext)).string();
+	for (int k = 1; !taken.insert(out).second; ++k)
+		out = (filesystem::path(dir) / (stem + "." + to_string(k) + ext)).string();
+	return out;
+}
+
+/*
+ * writes functions in the dialect of gcc -fdump-tree-ssa, of a shape
+ * given by the knobs below: straight blocks, if/else diamonds and counted
+ * loops nested up to depth. function k calls only functions below k, so
+ * the same seed always gives the same file.
+ */
+class SsaGenerator
+{
+	ostream *out;
+	mt19937_64 rng;
+	int next_block;
+	int version;
+	int fn;			// function being written
+	int ints;
+	int floats;
+	int pick(int n)
 	{
-		logger << "at line: " << line << " current char is " << ch << endl;
-		if (ch == '\0')
+		return uniform_int_distribution<int>(0, n - 1)(rng);
+	}
+	string name(const string &v)
+	{
+		return v + "_" + to_string(++version);
+	}
+	string int_var()
+	{
+		return name("i" + to_string(pick(ints)));
+	}
+	string float_var()
+	{
+		return name("x" + to_string(pick(floats)));
+	}
+	void label(int bb)
+	{
+		*out << "\n  <bb " << bb << ">:\n";
+	}
+	void statement();
+	void statements(int n);
+	void region(int budget, int d);
+public:
+	int functions = 10;
+	int blocks = 20;		// per function, roughly
+	int depth = 2;			// of nested loops
+	int vars = 16;			// locals per function
+	uint64_t seed = 1;
+	SsaGenerator() : out(nullptr), next_block(2), version(0), fn(0), ints(1), floats(1) {}
+	void generate(ostream &_out);
+};
+
+void SsaGenerator::statement()
+{
+	switch (pick(fn > 0 ? 8 : 7))
+	{
+	case 0:
+		*out << "  " << int_var() << " = " << int_var() << " + " << pick(11) - 5 << ";\n";
+		break;
+	case 1:
+		*out << "  " << int_var() << " = " << int_var() << (pick(2) ? " * " : " - ") << int_var() << ";\n";
+		break;
+	case 2:
+		*out << "  " << float_var() << " = " << float_var() << " + " << pick(9) + 1 << ".5e+0;\n";
+		break;
+	case 3:
+		*out << "  " << float_var() << " = " << float_var() << " * " << float_var() << ";\n";
+		break;
+	case 4:
+		if (pick(2))
+			*out << "  " << float_var() << " = (float) " << int_var() << ";\n";
+		else
+			*out << "  " << int_var() << " = (int) " << float_var() << ";\n";
+		break;
+	case 5:
+		*out << "  " << int_var() << " = " << int_var() << " / " << pick(7) + 2 << ";\n";
+		break;
+	case 6:
+		*out << "  " << int_var() << " = " << int_var() << ";\n";
+		break;
+	default:
+		/* callees are near, as in a layered program, so call chains stay short */
+		*out << "  " << int_var() << " = f" << fn - 1 - pick(min(fn, 4)) << " (" << int_var() << ", " << int_var() << ");\n";
+		break;
+	}
+}
+
+void SsaGenerator::statements(int n)
+{
+	for (int i = 0; i < n; ++i)
+		statement();
+}
+
+void SsaGenerator::region(int budget, int d)
+{
+	/* each piece starts with a label and falls through to whatever follows */
+	while (budget > 0)
+	{
+		int kind = pick(4);
+		if (kind == 0 && d > 0 && budget >= 4)
 		{
-			nextline();
+			int inner = 1 + pick(min(budget - 3, blocks));
+			int pre = next_block++, body = next_block++, cond = next_block++, exit = next_block++;
+			string n = "n" + to_string(d);
+			label(pre);
+			*out << "  " << name(n) << " = 0;\n  goto <bb " << cond << ">;\n";
+			label(body);
+			statements(1 + pick(3));
+			region(inner - 1, d - 1);
+			int latch = next_block++;
+			label(latch);
+			*out << "  " << name(n) << " = " << name(n) << " + 1;\n";
+			label(cond);
+			*out << "  if (" << name(n) << " < " << 1 + pick(100) << ")\n    goto <bb " << body << ">;\n  else\n    goto <bb " << exit << ">;\n";
+			label(exit);
+			statements(pick(3));
+			budget -= inner + 4;
 		}
-		else if ((ch == ' ') || (ch == '\t'))
+		else if (kind == 1 && budget >= 4)
 		{
-			strip();
+			int head = next_block++, then = next_block++, other = next_block++, join = next_block++;
+			static const char *ops[] = {"<", "<=", "==", "!=", ">", ">="};
+			label(head);
+			statements(pick(3));
+			*out << "  if (" << int_var() << " " << ops[pick(6)] << " " << pick(100) - 50 << ")\n    goto <bb " << then << ">;\n  else\n    goto <bb " << other << ">;\n";
+			label(then);
+			statements(1 + pick(3));
+			*out << "  goto <bb " << join << ">;\n";
+			label(other);
+			statements(1 + pick(3));
+			label(join);
+			statements(pick(3));
+			budget -= 4;
 		}
-		else if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch == '_') || (ch >= '0' && ch <= '9'))
+		else
 		{
-			if (states.top() == GLOBAL)
-			{
-				/* this should be head of a function */
-				states.push(FUNCTION_HEAD);
-				parse_function_head();
-				states.pop();
-			}
-			else if (states.top() == FUNCTION_BODY)
-			{
-				/* this should be def or use */
-				parse_statement();
-			}
+			label(next_block++);
+			statements(1 + pick(4));
+			budget--;
 		}
-		else if (ch == '{')
+	}
+}
+
+void SsaGenerator::generate(ostream &_out)
+{
+	out = &_out;
+	rng.seed(seed);
+	version = 0;
+	ints = max(1, vars * 2 / 3);
+	floats = max(1, vars - ints);
+	for (fn = 0; fn < functions; ++fn)
+	{
+		next_block = 2;
+		*out << ";; Function f" << fn << " (f" << fn << ", funcdef_no=" << fn << ")\n\n"
+			<< "f" << fn << " (int p0, int p1)\n{\n";
+		for (int i = 0; i < ints; ++i)
+			*out << "  int i" << i << ";\n";
+		for (int i = 0; i < floats; ++i)
+			*out << "  float x" << i << ";\n";
+		for (int i = 1; i <= depth; ++i)
+			*out << "  int n" << i << ";\n";
+		*out << "  int r;\n";
+		label(next_block++);
+		/* some locals start from the parameters, the rest from constants */
+		for (int i = 0; i < ints; ++i)
+			if (i % 3 == 0)
+				*out << "  " << name("i" + to_string(i)) << " = " << (i % 2 ? "p1_" : "p0_") << ++version << "(D);\n";
+			else
+				*out << "  " << name("i" + to_string(i)) << " = " << pick(100) << ";\n";
+		for (int i = 0; i < floats; ++i)
+			*out << "  " << name("x" + to_string(i)) << " = (float) " << int_var() << ";\n";
+		region(blocks - 2, depth);
+		label(next_block++);
+		*out << "  " << name("r") << " = " << int_var() << ";\n"
+			<< "<L" << next_block << ">:\n  return " << name("r") << ";\n\n}\n\n";
+	}
+}
+
+/* the peak resident set of the process so far, in MB, 0 where unknown */
+double peak_rss()
+{
+#ifdef _WIN32
+	return 0;
+#else
+	struct rusage use;
+	if (getrusage(RUSAGE_SELF, &use) != 0)
+		return 0;
+	return use.ru_maxrss / 1024.0;		// kB on linux
+#endif
+}
+
+/*
+ * parses and solves each input repeat times and reports its fastest run.
+ * statements per second are over solving; parsing is measured in MB/s
+ */
+int bench(const vector<string> &inputs, int threads, int repeat, ENGINE engine, const Budget &budget)
+{
+	typedef chrono::steady_clock clock_type;
+	int status = 0;
+	for (auto i = inputs.begin(); i != inputs.end(); ++i)
+	{
+		double parse_ms = 0, solve_ms = 0;
+		size_t size = 0, statements = 0, blocks = 0;
+		long long iterations = 0;
+		bool clean = true;
+		for (int r = 0; r < repeat; ++r)
 		{
-			if (states.top() == GLOBAL)
+			MappedFile file;
+			if (!file.open(*i))
 			{
-				/* this should be body of current function */
-				states.push(FUNCTION_BODY);
-				ch = buffer[p++];
+				cout << "[ERROR] can not open " << *i << endl;
+				clean = false;
+				break;
 			}
+			GlobalTable table;
+			table.engine = engine;
+			table.budget = budget;
+			auto t0 = clock_type::now();
+			SSAHandler h(file, table);
+			h.parse();
+			auto t1 = clock_type::now();
+			table.analyze(threads);
+			auto t2 = clock_type::now();
+			double p = chrono::duration<double, milli>(t1 - t0).count();
+			double s = chrono::duration<double, milli>(t2 - t1).count();
+			if (r == 0 || p < parse_ms)
+				parse_ms = p;
+			if (r == 0 || s < solve_ms)
+				solve_ms = s;
+			if (r > 0)
+				continue;
+			size = file.size;
+			statements = blocks = 0;
+			for (auto f = table.funcs.begin(); f != table.funcs.end(); ++f)
+				if (*f != nullptr)
+					for (auto b = (*f)->blocks.begin(); b != (*f)->blocks.end(); ++b)
+						if (*b != nullptr)
+						{
+							blocks++;
+							statements += (*b)->count;
+						}
+			iterations = table.iterations;
+			vector<myError> errors = h.errors;
+			table.collect(errors);
+			clean = all_of(errors.begin(), errors.end(), [](const myError &e) { return e.warning(); });
 		}
-		else if (ch == '}')
+		if (!clean)
 		{
-			if (states.top() == FUNCTION_BODY)
-			{
-				/* this is end of function */
-				states.pop();
-				states.push(GLOBAL);
-				ch = buffer[p++];
-				for (auto i = table.funcs[cur_func_name]->blocks.begin(); i != table.funcs[cur_func_name]->blocks.end(); ++i)
-				{
-					auto &v = i->second->next;
-					for (auto j = v.begin(); j != v.end(); j++)
-					{
-						table.funcs[cur_func_name]->blocks[*j]->pre.push_back(i->first);
-					}
-				}
-				cur_func_name = cur_block_name = "0";
-			}
+			status = 1;
+			if (size == 0)
+				continue;
 		}
-		else if (ch == ';')
+		double mb = size / 1048576.0;
+		cout << *i << ": " << mb << " MB, parse " << parse_ms << " ms ("
+			<< (parse_ms > 0 ? mb / parse_ms * 1000 : 0) << " MB/s), solve " << solve_ms << " ms ("
+			<< (solve_ms > 0 ? statements / solve_ms * 1000 : 0) << " statements/s), "
+			<< statements << " statements, " << blocks << " blocks, "
+			<< (blocks > 0 ? (double)iterations / blocks : 0) << " iterations/block, peak RSS "
+			<< peak_rss() << " MB" << (clean ? "" : ", with diagnostics") << endl;
+	}
+	return status;
+}
+
+/* an input --serve keeps in memory, parsed once and queried many times */
+class Served
+{
+public:
+	string path;
+	uint64_t hash = 0;
+	MappedFile file;
+	unique_ptr<GlobalTable> table;
+	int functions = 0;
+	int diagnostics = 0;	// of its parse
+};
+
+/* parses path into a fresh Served, nullptr when it can not be read */
+unique_ptr<Served> serve_load(const string &path, ENGINE engine, const Budget &budget)
+{
+	unique_ptr<Served> s(new Served());
+	s->path = path;
+	if (!s->file.open(path))
+		return nullptr;
+	s->hash = content_hash(s->file.data, s->file.size);
+	s->table.reset(new GlobalTable());
+	s->table->engine = engine;
+	s->table->budget = budget;
+	SSAHandler h(s->file, *s->table);
+	h.parse();
+	for (auto f = s->table->funcs.begin(); f != s->table->funcs.end(); ++f)
+		s->functions += *f != nullptr;
+	s->diagnostics = h.errors.size();
+	return s;
+}
+
+/*
+ * --serve: inputs stay parsed and what queries solved stays solved, so a
+ * query costs only what it has not asked before. requests come a line at
+ * a time on in, each gets one reply line on out, ok and what was asked or
+ * error and why:
+ *   load PATH     parse PATH and keep it, ok N functions, M diagnostics
+ *   reload PATH   parse PATH again when its content changed, or ok unchanged
+ *   drop PATH     forget PATH
+ *   query F:B:V   the range of V where block B of F begins, from the first
+ *                 kept input defining F
+ *   list          the kept inputs, tab separated
+ *   quit          ends, as the end of in does
+ */
+int serve(istream &in, ostream &out, const vector<string> &inputs, ENGINE engine, const Budget &budget)
+{
+	vector<unique_ptr<Served>> kept;
+	auto find = [&kept](const string &path) {
+		for (auto k = kept.begin(); k != kept.end(); ++k)
+			if ((*k)->path == path)
+				return k;
+		return kept.end();
+	};
+	for (auto i = inputs.begin(); i != inputs.end(); ++i)
+	{
+		unique_ptr<Served> s = serve_load(*i, engine, budget);
+		if (s)
+			kept.push_back(move(s));
+	}
+	EmitOptions text;
+	string line;
+	while (getline(in, line))
+	{
+		size_t space = line.find(' ');
+		string verb = line.substr(0, space), arg = space == string::npos ? string() : line.substr(space + 1);
+		if (verb == "quit")
+			break;
+		if (verb == "load" || verb == "reload")
 		{
-			if (states.top() == GLOBAL)
+			auto k = find(arg);
+			if (verb == "reload" && k != kept.end())
 			{
-				ch = buffer[p++];
-				if (ch == ';')
-				{
-					nextline();
-				}
-				else
+				MappedFile now;
+				if (now.open(arg) && content_hash(now.data, now.size) == (*k)->hash)
 				{
-					global_error.set(SYNTEXT_ERROR, string("[ERROR] ';' outside function"), line);
-					global_error.give_msg();
+					out << "ok unchanged" << endl;
+					continue;
 				}
 			}
+			unique_ptr<Served> s = serve_load(arg, engine, budget);
+			if (!s)
+			{
+				out << "error can not open " << arg << endl;
+				continue;
+			}
+			out << "ok " << s->functions << " functions, " << s->diagnostics << " diagnostics" << endl;
+			if (k != kept.end())
+				*k = move(s);
 			else
+				kept.push_back(move(s));
+		}
+		else if (verb == "drop")
+		{
+			auto k = find(arg);
+			if (k == kept.end())
 			{
-				ch = buffer[p++];
+				out << "error " << arg << " is not kept" << endl;
+				continue;
 			}
+			kept.erase(k);
+			out << "ok" << endl;
 		}
-		else if (ch == '#')
+		else if (verb == "list")
 		{
-			nextline();
+			out << "ok";
+			for (auto k = kept.begin(); k != kept.end(); ++k)
+				out << "\t" << (*k)->path;
+			out << endl;
 		}
-		else if (ch == '<')
+		else if (verb == "query")
 		{
-			/* this is block */
-			char blockname[100];
-			int pname = 0;
-			ch = buffer[p++];
-			while (ch != '>')
+			Query q;
+			if (!read_query(arg, q))
 			{
-				blockname[pname++] = ch;
-				ch = buffer[p++];
+				out << "error a query is func:block:var" << endl;
+				continue;
 			}
-			blockname[pname] = '\0';
-			ch = buffer[p++];	// this is '>'
-			ch = buffer[p++];	// this is ':'
-			string bname = blockname;
-			if (cur_block_name != "0")
+			/* the first kept input defining the function answers */
+			string bad = "error query " + arg + " names no function defined";
+			for (auto k = kept.begin(); k != kept.end(); ++k)
 			{
-				table.funcs[cur_func_name]->blocks[cur_block_name]->next.push_back(bname);
+				GlobalTable &table = *(*k)->table;
+				sym_t f, b, v;
+				string why = table.resolve(q, f, b, v);
+				if (f == NO_SYM || table.funcs[f] == nullptr)
+					continue;
+				if (!why.empty())
+				{
+					bad = "error " + why;
+					break;
+				}
+				Emitter e(text);
+				table.query(f, b, v).draw(e, q.var);
+				e.buf.erase(e.buf.find_last_not_of(' ') + 1);
+				bad = "ok " + e.buf;
+				break;
 			}
-			cur_block_name = bname;
-			table.funcs[cur_func_name]->add_block(bname);
+			out << bad << endl;
 		}
+		else
+			out << "error unknown request " << verb << endl;
 	}
-	cout << "parse done!" << endl;
-	if (draw)
-		table.draw();
+	return 0;
 }
 
-void parse_ssa(fstream &file, bool draw=false)
+void usage(const char *self)
 {
-	SSAHandler h(file);
-	h.parse(draw);
+	cout << "usage: " << self << " [-j threads] [-o dir] [-c dir] [-n] [-s] [-f format] [--engine e] [--max-iterations n] [--max-ms ms] [--func f] [--var v] [--scenarios f] [--query q] input...\n"
+		<< "       " << self << " --bench [--repeat n] [-j threads] [--engine e] [--max-iterations n] [--max-ms ms] input...\n"
+		<< "       " << self << " --serve [--engine e] [--max-iterations n] [--max-ms ms] [input...]\n"
+		<< "       " << self << " --generate out.ssa [--functions n] [--blocks n] [--depth n] [--vars n] [--seed n]\n"
+		<< "  input       a .ssa file, a directory searched for them, a glob, or @file listing inputs\n"
+		<< "  -j threads  threads to analyze with, default one per core\n"
+		<< "  -o dir      write a.range for each a.ssa into dir instead of beside it\n"
+		<< "  -c dir      keep parsed inputs and results in dir, unchanged inputs are not\n"
+		<< "              parsed again and unchanged functions are not solved again\n"
+		<< "  -n          analyze only, write no results\n"
+		<< "  -s          stream, keep one function of a file in memory at a time;\n"
+		<< "              functions are written in definition order, not by name\n"
+		<< "  -f format   text (default) to a.range, json to a.jsonl with a line per\n"
+		<< "              function, or binary to a.rbin\n"
+		<< "  --engine e  dense (default) solves block by block over whole states,\n"
+		<< "              sparse over an SSA graph of the definitions\n"
+		<< "  --max-iterations n, --max-ms ms  budget of each solve of a function; past\n"
+		<< "              it loops are widened to infinity at once, the function is\n"
+		<< "              marked approximate and warned about, the exit status stays 0\n"
+		<< "  --func f    write only function f, may be repeated\n"
+		<< "  --var v     write only variable v, may be repeated\n"
+		<< "  --stats f   write phase times and per function counters of the run to f as json\n"
+		<< "  --scenarios f  solve each function again for every line of f, a set of\n"
+		<< "              parameter ranges like n=[0,10] m=(-inf,0]; results give the\n"
+		<< "              return and variable ranges per scenario; -s is ignored\n"
+		<< "  --query q   write only the range of var where block of func begins, for\n"
+		<< "              q as func:block:var, solving only what it depends on; may be\n"
+		<< "              repeated; -s and -c results are ignored\n"
+		<< "  --bench     parse and solve each input, write nothing, and report the\n"
+		<< "              fastest of --repeat runs (3): MB/s parsed, statements/s\n"
+		<< "              solved, iterations per block and peak RSS\n"
+		<< "  --serve     keep inputs parsed and answer requests, a line each on stdin:\n"
+		<< "              load PATH, reload PATH, drop PATH, query F:B:V, list, quit;\n"
+		<< "              each gets a line on stdout, ok and the answer or error and why\n"
+		<< "  --generate  write a synthetic input of --functions functions (10) of about\n"
+		<< "              --blocks blocks (20), loops nested --depth deep (2), --vars\n"
+		<< "              locals (16); the same --seed (1) gives the same file\n"
+		<< "exit status is 0 when every input was analyzed cleanly, 1 when any gave\n"
+		<< "a diagnostic other than a warning and 2 when the command line is wrong\n";
 }
 
-void handle(string filename, bool draw = false)
+int main(int argc, char *argv[])
 {
-	int length = filename.length();
-	string ext = filename.substr(length - 3);
-	if (ext != "ssa")
+	int threads = 0;
+	string dir, cache_dir;
+	bool draw = true;
+	bool streaming = false;
+	bool benchmark = false;
+	bool serving = false;
+	string stats_path;
+	string scenario_path;
+	vector<Scenario> scenarios;
+	vector<Query> queries;
+	ENGINE engine = EN_DENSE;
+	Budget budget;
+	EmitOptions options;
+	int repeat = 3;
+	string generated;
+	SsaGenerator gen;
+	int status = 0;
+	vector<string> inputs;
+	for (int i = 1; i < argc; ++i)
 	{
-		string msg = "The file given is ";
-		msg += filename;
-		global_error.set(NOTSSA, msg, 0);
-		global_error.give_msg();
-		return;
+		string a = argv[i];
+		if (a == "-j" && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (a.size() > 2 && a.compare(0, 2, "-j") == 0)
+			threads = atoi(a.c_str() + 2);
+		else if (a == "-o" && i + 1 < argc)
+			dir = argv[++i];
+		else if (a == "-c" && i + 1 < argc)
+			cache_dir = argv[++i];
+		else if (a == "-n")
+			draw = false;
+		else if (a == "-s")
+			streaming = true;
+		else if (a == "-f" && i + 1 < argc)
+		{
+			string f = argv[++i];
+			if (f == "text")
+				options.format = FMT_TEXT;
+			else if (f == "json")
+				options.format = FMT_JSON;
+			else if (f == "binary")
+				options.format = FMT_BINARY;
+			else
+			{
+				usage(argv[0]);
+				return 2;
+			}
+		}
+		else if (a == "--engine" && i + 1 < argc)
+		{
+			string e = argv[++i];
+			if (e == "dense")
+				engine = EN_DENSE;
+			else if (e == "sparse")
+				engine = EN_SPARSE;
+			else
+			{
+				usage(argv[0]);
+				return 2;
+			}
+		}
+		else if (a == "--max-iterations" && i + 1 < argc)
+			budget.iterations = max(0LL, atoll(argv[++i]));
+		else if (a == "--max-ms" && i + 1 < argc)
+			budget.ms = max(0LL, atoll(argv[++i]));
+		else if (a == "--func" && i + 1 < argc)
+			options.funcs.insert(argv[++i]);
+		else if (a == "--var" && i + 1 < argc)
+			options.vars.insert(argv[++i]);
+		else if (a == "--stats" && i + 1 < argc)
+			stats_path = argv[++i];
+		else if (a == "--scenarios" && i + 1 < argc)
+			scenario_path = argv[++i];
+		else if (a == "--query" && i + 1 < argc)
+		{
+			queries.push_back(Query());
+			if (!read_query(argv[++i], queries.back()))
+			{
+				cout << "[ERROR] a query is func:block:var, not " << argv[i] << endl;
+				return 2;
+			}
+		}
+		else if (a == "--bench")
+			benchmark = true;
+		else if (a == "--serve")
+			serving = true;
+		else if (a == "--repeat" && i + 1 < argc)
+			repeat = max(1, atoi(argv[++i]));
+		else if (a == "--generate" && i + 1 < argc)
+			generated = argv[++i];
+		else if (a == "--functions" && i + 1 < argc)
+			gen.functions = max(1, atoi(argv[++i]));
+		else if (a == "--blocks" && i + 1 < argc)
+			gen.blocks = max(2, atoi(argv[++i]));
+		else if (a == "--depth" && i + 1 < argc)
+			gen.depth = max(0, atoi(argv[++i]));
+		else if (a == "--vars" && i + 1 < argc)
+			gen.vars = max(2, atoi(argv[++i]));
+		else if (a == "--seed" && i + 1 < argc)
+			gen.seed = strtoull(argv[++i], nullptr, 10);
+		else if (a == "-h" || a == "--help")
+		{
+			usage(argv[0]);
+			return 0;
+		}
+		else if (a.size() > 1 && a[0] == '-')
+		{
+			usage(argv[0]);
+			return 2;
+		}
+		else if (!expand_input(a, inputs))
+		{
+			cout << "[ERROR] no input found for " << a << endl;
+			status = 1;
+		}
+	}
+	if (!generated.empty())
+	{
+		ofstream file(generated);
+		gen.generate(file);
+		if (!file.flush())
+		{
+			cout << "[ERROR] can not write " << generated << endl;
+			return 2;
+		}
+		if (inputs.empty() && status == 0)
+			return 0;
+	}
+	if (serving)
+		return max(status, serve(cin, cout, inputs, engine, budget));
+	if (inputs.empty())
+	{
+		if (status == 0)
+			usage(argv[0]);
+		return 2;
+	}
+	if (benchmark)
+		return max(status, bench(inputs, threads, repeat, engine, budget));
+	if (!scenario_path.empty())
+	{
+		int bad;
+		if (!read_scenarios(scenario_path, scenarios, bad))
+		{
+			cout << "[ERROR] can not read " << scenario_path;
+			if (bad > 0)
+				cout << ", line " << bad;
+			cout << endl;
+			return 2;
+		}
+		/* every function has to stay in memory to be solved again */
+		streaming = false;
+	}
+	if (!queries.empty())
+		streaming = false;
+	error_code ec;
+	if (draw && !dir.empty() && !filesystem::create_directories(dir, ec) && ec)
+	{
+		cout << "[ERROR] can not create " << dir << endl;
+		return 2;
+	}
+	if (!cache_dir.empty() && !filesystem::create_directories(cache_dir, ec) && ec)
+	{
+		cout << "[ERROR] can not create " << cache_dir << endl;
+		return 2;
+	}
+	/* the same file named twice is analyzed once */
+	vector<Job> jobs;
+	set<string> seen, taken;
+	for (auto i = inputs.begin(); i != inputs.end(); ++i)
+	{
+		if (!seen.insert(*i).second)
+			continue;
+		jobs.push_back(Job());
+		jobs.back().input = *i;
+		jobs.back().size = filesystem::file_size(*i, ec);
+		jobs.back().streaming = streaming;
+		jobs.back().cache_dir = cache_dir;
+		jobs.back().options = options;
+		jobs.back().engine = engine;
+		jobs.back().budget = budget;
+		if (!scenario_path.empty())
+			jobs.back().scenarios = &scenarios;
+		if (!queries.empty())
+			jobs.back().queries = &queries;
+		if (!stats_path.empty())
+			jobs.back().stats.reset(new Stats());
+		if (draw)
+			jobs.back().output = output_for(*i, dir, options.extension(), taken);
+	}
+	/* the largest files go first; with fewer files than threads, each file
+	 * spreads its functions over its share of the pool */
+	vector<int> order(jobs.size());
+	for (int i = 0; i < order.size(); ++i)
+		order[i] = i;
+	stable_sort(order.begin(), order.end(), [&jobs](int a, int b) { return jobs[a].size > jobs[b].size; });
+	WorkPool pool(threads);
+	int share = max(1, pool.threads / (int)jobs.size());
+	pool.run(order, [&jobs, share](int i) { jobs[i].run(share); });
+	for (auto j = jobs.begin(); j != jobs.end(); ++j)
+	{
+		cout << j->input;
+		if (!j->output.empty())
+			cout << " -> " << j->output;
+		if (j->cached)
+			cout << " (cached)";
+		if (j->reused >= 0)
+			cout << " (" << j->reused << " of " << j->functions << " functions reused)";
+		cout << endl;
+		for (auto e = j->errors.begin(); e != j->errors.end(); ++e)
+		{
+			e->give_msg();
+			if (!e->warning())
+				status = 1;
+		}
+	}
+	if (!stats_path.empty())
+	{
+		/* one document for the run, phases summed over inputs first */
+		ofstream out(stats_path);
+		out << "{\"phases_ms\": {";
+		for (int p = 0; p < PH_COUNT; ++p)
+		{
+			long long t = 0;
+			for (auto j = jobs.begin(); j != jobs.end(); ++j)
+				t += j->stats->own((PHASE)p);
+			out << (p ? ", " : "") << '"' << phase_name[p] << "\": " << t / 1e6;
+		}
+		out << "},\n\"inputs\": [";
+		for (auto j = jobs.begin(); j != jobs.end(); ++j)
+		{
+			out << (j == jobs.begin() ? "\n" : ",\n");
+			j->stats->write(out, j->input);
+		}
+		out << "]}\n";
+		if (!out.flush())
+		{
+			cout << "[ERROR] can not write " << stats_path << endl;
+			status = 1;
+		}
 	}
-	fstream file;
-	file.open(filename.c_str(), ios::in);
-	parse_ssa(file, draw);
-	file.close();
+	return status;
 }
-
-int main()
-{
-	handle(string("t10.ssa"), true);
-	system("pause");
-	return 0;
-}
\ No newline at end of file